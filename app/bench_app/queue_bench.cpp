@@ -0,0 +1,98 @@
+#include "common/mpmc_queue.hpp"
+#include "common/safe_queue.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+// 多生产者写入、消费者读出, 对比互斥锁队列与无锁队列的吞吐
+// 用法: queue_bench [每轮消息总数] [消费者数量]
+
+struct Sample
+{
+    uint64_t seq;
+    uint32_t producer;
+    uint32_t payload[6];
+};
+
+template <typename Queue>
+double run_once(size_t producers, size_t consumers, size_t total)
+{
+    Queue queue(1024);
+    std::atomic<size_t> received{0};
+    std::atomic<bool> start{false};
+    size_t per_producer = total / producers;
+    size_t expected = per_producer * producers;
+
+    std::vector<std::thread> threads;
+    for (size_t c = 0; c < consumers; ++c)
+    {
+        threads.emplace_back([&]() {
+            Sample sample;
+            while (received.load(std::memory_order_relaxed) < expected)
+            {
+                if (queue.pop(sample))
+                {
+                    if (received.fetch_add(1, std::memory_order_relaxed) + 1 == expected)
+                    {
+                        queue.stop();
+                    }
+                }
+            }
+        });
+    }
+    for (size_t p = 0; p < producers; ++p)
+    {
+        threads.emplace_back([&, p]() {
+            while (!start.load(std::memory_order_acquire))
+            {
+                std::this_thread::yield();
+            }
+            Sample sample{};
+            sample.producer = static_cast<uint32_t>(p);
+            for (size_t i = 0; i < per_producer; ++i)
+            {
+                sample.seq = i;
+                while (!queue.push(sample))
+                {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    auto begin = std::chrono::steady_clock::now();
+    start.store(true, std::memory_order_release);
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    return expected / seconds / 1e6;
+}
+
+int main(int argc, char **argv)
+{
+    size_t total = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 2000000;
+    size_t consumers = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1;
+    if (total == 0 || consumers == 0)
+    {
+        std::fprintf(stderr, "usage: %s [messages] [consumers]\n", argv[0]);
+        return -1;
+    }
+
+    std::printf("%zu messages of %zu bytes, %zu consumer(s), %u cpus, capacity 1024\n",
+                total, sizeof(Sample), consumers, std::thread::hardware_concurrency());
+    std::printf("%-10s %18s %18s %8s\n", "producers", "SafeQueue Mmsg/s", "MpmcQueue Mmsg/s", "speedup");
+    for (size_t producers : {1, 2, 4, 8})
+    {
+        double locked = run_once<SafeQueue<Sample>>(producers, consumers, total);
+        double lock_free = run_once<MpmcQueue<Sample>>(producers, consumers, total);
+        std::printf("%-10zu %18.2f %18.2f %7.2fx\n", producers, locked, lock_free, lock_free / locked);
+    }
+    return 0;
+}
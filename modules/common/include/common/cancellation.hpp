@@ -0,0 +1,68 @@
+#ifndef __CANCELLATION_H__
+#define __CANCELLATION_H__
+
+#include <atomic>
+#include <memory>
+
+/**
+ * @brief Read side of a cancellation flag, cheap to copy and poll
+ * @note A default constructed token can never be cancelled
+ */
+class CancellationToken {
+public:
+    CancellationToken() = default;
+
+    /**
+     * @brief Check if cancellation was requested
+     */
+    bool is_cancelled() const {
+        return flag_ && flag_->load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Check if the token is bound to a CancellationSource
+     */
+    bool can_be_cancelled() const {
+        return static_cast<bool>(flag_);
+    }
+
+private:
+    friend class CancellationSource;
+    explicit CancellationToken(std::shared_ptr<std::atomic<bool>> flag) : flag_(std::move(flag)) {}
+
+    std::shared_ptr<std::atomic<bool>> flag_;
+};
+
+/**
+ * @brief Write side of a cancellation flag
+ *
+ *   CancellationSource source;
+ *   TaskOptions opts;
+ *   opts.token = source.token();
+ *   pool.submit_with(opts, process, frame);
+ *   source.cancel();  // dropped if not started yet, ThreadPool::current_token() turns true if running
+ */
+class CancellationSource {
+public:
+    CancellationSource() : flag_(std::make_shared<std::atomic<bool>>(false)) {}
+
+    /**
+     * @brief Request cancellation of every task holding a token of this source
+     */
+    void cancel() {
+        flag_->store(true, std::memory_order_relaxed);
+    }
+
+    bool is_cancelled() const {
+        return flag_->load(std::memory_order_relaxed);
+    }
+
+    CancellationToken token() const {
+        return CancellationToken(flag_);
+    }
+
+private:
+    std::shared_ptr<std::atomic<bool>> flag_;
+};
+
+#endif // __CANCELLATION_H__
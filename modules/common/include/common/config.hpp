@@ -40,6 +40,24 @@ public:
     // Deprecated: Use GetInstance().LoadFile() instead
     static bool SetParameterFile(const std::string &filename);
 
+    /**
+     * @brief Check if a parameter exists, without logging
+     * @param father_key Parent key in YAML
+     * @param child_key Child key in YAML
+     * @return true if the configuration is loaded and father_key.child_key is present
+     */
+    static bool HasParam(const std::string& father_key, const std::string& child_key) {
+        auto& instance = GetInstance();
+        if (!instance.param_file_) {
+            return false;
+        }
+        try {
+            return static_cast<bool>(instance.param_file_[father_key][child_key]);
+        } catch (const YAML::Exception&) {
+            return false;
+        }
+    }
+
     /**
      * @brief Get parameter value with optional default
      * @tparam T Type of the parameter
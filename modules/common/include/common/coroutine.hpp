@@ -0,0 +1,308 @@
+#ifndef __COROUTINE_H__
+#define __COROUTINE_H__
+
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+
+#include "singleton.hpp"
+#include "thread_pool.hpp"
+#include "timer.hpp"
+
+#include <cerrno>
+#include <chrono>
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <utility>
+
+/**
+ * Coroutines on top of ThreadPool (requires C++20)
+ *
+ *   Task<int> stage(ThreadPool& pool) {
+ *       co_await pool.schedule();                    // continue on a pool worker
+ *       int a = co_await pool.async(compute);        // no thread blocks while waiting
+ *       co_await sleep_for(pool, std::chrono::milliseconds(10));
+ *       co_return a + 1;
+ *   }
+ *   int v = co_spawn(pool, stage(pool)).get();
+ */
+
+template <typename T = void> class Task;
+
+namespace detail {
+
+struct TaskPromiseBase {
+    struct FinalAwaiter {
+        bool await_ready() const noexcept { return false; }
+
+        template <typename Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept {
+            return handle.promise().continuation;
+        }
+
+        void await_resume() const noexcept {}
+    };
+
+    std::suspend_always initial_suspend() const noexcept { return {}; }
+    FinalAwaiter final_suspend() const noexcept { return {}; }
+
+    void unhandled_exception() noexcept {
+        error = std::current_exception();
+    }
+
+    std::coroutine_handle<> continuation = std::noop_coroutine();
+    std::exception_ptr error;
+};
+
+template <typename T>
+struct TaskPromise : TaskPromiseBase {
+    Task<T> get_return_object() noexcept;
+
+    template <typename U>
+    void return_value(U&& value) {
+        value_.emplace(std::forward<U>(value));
+    }
+
+    T result() {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+        return std::move(*value_);
+    }
+
+    std::optional<T> value_;
+};
+
+template <>
+struct TaskPromise<void> : TaskPromiseBase {
+    Task<void> get_return_object() noexcept;
+
+    void return_void() const noexcept {}
+
+    void result() {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+};
+
+// Fire-and-forget coroutine that frees itself when finished
+struct DetachedTask {
+    struct promise_type {
+        DetachedTask get_return_object() const noexcept { return {}; }
+        std::suspend_never initial_suspend() const noexcept { return {}; }
+        std::suspend_never final_suspend() const noexcept { return {}; }
+        void return_void() const noexcept {}
+        void unhandled_exception() const noexcept { std::terminate(); }
+    };
+};
+
+}  // namespace detail
+
+/**
+ * @brief Lazily started coroutine returning T
+ * @note Runs when awaited or passed to co_spawn; owns its frame
+ */
+template <typename T>
+class Task {
+public:
+    using promise_type = detail::TaskPromise<T>;
+    using Handle = std::coroutine_handle<promise_type>;
+
+    Task() noexcept = default;
+    explicit Task(Handle handle) noexcept : handle_(handle) {}
+
+    Task(Task&& other) noexcept : handle_(std::exchange(other.handle_, {})) {}
+
+    Task& operator=(Task&& other) noexcept {
+        if (this != &other) {
+            destroy();
+            handle_ = std::exchange(other.handle_, {});
+        }
+        return *this;
+    }
+
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+
+    ~Task() {
+        destroy();
+    }
+
+    bool valid() const noexcept {
+        return static_cast<bool>(handle_);
+    }
+
+    auto operator co_await() && noexcept {
+        struct Awaiter {
+            Handle handle;
+
+            bool await_ready() const noexcept {
+                return !handle || handle.done();
+            }
+
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> caller) noexcept {
+                handle.promise().continuation = caller;
+                return handle;  // symmetric transfer, no stack growth
+            }
+
+            T await_resume() {
+                return handle.promise().result();
+            }
+        };
+        return Awaiter{handle_};
+    }
+
+private:
+    void destroy() noexcept {
+        if (handle_) {
+            handle_.destroy();
+            handle_ = {};
+        }
+    }
+
+    Handle handle_;
+};
+
+namespace detail {
+
+template <typename T>
+inline Task<T> TaskPromise<T>::get_return_object() noexcept {
+    return Task<T>(std::coroutine_handle<TaskPromise<T>>::from_promise(*this));
+}
+
+inline Task<void> TaskPromise<void>::get_return_object() noexcept {
+    return Task<void>(std::coroutine_handle<TaskPromise<void>>::from_promise(*this));
+}
+
+template <typename T>
+DetachedTask run_detached(ThreadPool& pool, Task<T> task, Promise<T> promise) {
+    try {
+        co_await pool.schedule();
+        if constexpr (std::is_void<T>::value) {
+            co_await std::move(task);
+            promise.set_value();
+        } else {
+            promise.set_value(co_await std::move(task));
+        }
+    } catch (...) {
+        promise.set_exception(std::current_exception());
+    }
+}
+
+}  // namespace detail
+
+/**
+ * @brief Start a task on the pool
+ * @param pool Pool that runs the task's first step
+ * @param task Task to run, consumed
+ * @return Future of the task's result, continuations run on the pool
+ */
+template <typename T>
+Future<T> co_spawn(ThreadPool& pool, Task<T> task) {
+    Promise<T> promise(&pool);
+    auto future = promise.get_future();
+    detail::run_detached(pool, std::move(task), std::move(promise));
+    return future;
+}
+
+/**
+ * @brief Awaitable for Future, the coroutine is resumed on the future's executor
+ */
+template <typename T>
+struct FutureAwaiter {
+    Future<T> future;
+
+    bool await_ready() const {
+        return future.is_ready();
+    }
+
+    void await_suspend(std::coroutine_handle<> handle) {
+        Executor* executor = future.executor();
+        future.on_ready([executor, handle]() {
+            detail::schedule_on(executor, [handle]() { handle.resume(); });
+        });
+    }
+
+    T await_resume() {
+        return future.get();
+    }
+};
+
+template <typename T>
+FutureAwaiter<T> operator co_await(Future<T>&& future) {
+    return FutureAwaiter<T>{std::move(future)};
+}
+
+template <typename T>
+FutureAwaiter<T> operator co_await(Future<T>& future) {
+    return FutureAwaiter<T>{std::move(future)};
+}
+
+/**
+ * @brief Awaitable that resumes on the pool at the given time, no thread is held while waiting
+ */
+struct SleepAwaiter {
+    ThreadPool* pool;
+    TimerQueue::Clock::time_point when;
+    TimerQueue* timers;
+
+    bool await_ready() const {
+        return TimerQueue::Clock::now() >= when;
+    }
+
+    void await_suspend(std::coroutine_handle<> handle) {
+        ThreadPool* target = pool;
+        timers->schedule_at(when, [target, handle]() {
+            detail::schedule_on(target, [handle]() { handle.resume(); });
+        });
+    }
+
+    void await_resume() const noexcept {}
+};
+
+/**
+ * @brief co_await sleep_until(pool, t): resume on pool at t
+ * @param timers Timer thread serving the wait, shared by all coroutines by default
+ */
+inline SleepAwaiter sleep_until(ThreadPool& pool, TimerQueue::Clock::time_point when,
+                                TimerQueue& timers = Singleton<TimerQueue>::instance()) {
+    return SleepAwaiter{&pool, when, &timers};
+}
+
+/**
+ * @brief co_await sleep_for(pool, d): resume on pool after d
+ */
+template <typename Rep, typename Period>
+SleepAwaiter sleep_for(ThreadPool& pool, const std::chrono::duration<Rep, Period>& delay,
+                       TimerQueue& timers = Singleton<TimerQueue>::instance()) {
+    return SleepAwaiter{&pool, TimerQueue::Clock::now() + std::chrono::duration_cast<TimerQueue::Clock::duration>(delay),
+                        &timers};
+}
+
+/**
+ * @brief Receive from an IPC queue without holding a thread while it is empty
+ * @tparam Queue Type with bool try_recv(Message&) that sets errno to ENOMSG when empty, e.g. MessageQueue
+ * @param pool Pool the coroutine resumes on
+ * @param queue Queue to receive from
+ * @param msg Output message
+ * @param poll_interval Delay between attempts while the queue is empty
+ * @return true on success, false on queue error (e.g. queue removed)
+ * @note System V queues cannot be polled with epoll, so emptiness is checked on a timer
+ */
+template <typename Queue, typename Rep = int64_t, typename Period = std::milli>
+Task<bool> async_recv(ThreadPool& pool, Queue& queue, typename Queue::Message& msg,
+                      std::chrono::duration<Rep, Period> poll_interval = std::chrono::milliseconds(1)) {
+    for (;;) {
+        if (queue.try_recv(msg)) {
+            co_return true;
+        }
+        if (errno != ENOMSG && errno != EINTR) {
+            co_return false;
+        }
+        co_await sleep_for(pool, poll_interval);
+    }
+}
+
+#endif // __cpp_impl_coroutine
+
+#endif // __COROUTINE_H__
@@ -0,0 +1,582 @@
+#ifndef __FUTURE_H__
+#define __FUTURE_H__
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Something that can run a task later, e.g. ThreadPool
+ */
+class Executor {
+public:
+    virtual ~Executor() = default;
+
+    /**
+     * @brief Schedule a task, must not block the caller
+     * @param task Task to run
+     */
+    virtual void post(std::function<void()> task) = 0;
+
+    /**
+     * @brief Run one queued task on the calling thread, used to help while waiting
+     * @return false if nothing was run (queue empty, or the caller may not run tasks of this executor)
+     */
+    virtual bool run_pending_task() {
+        return false;
+    }
+
+    /**
+     * @brief Check if run_pending_task() may run anything on the calling thread
+     * @note Waiters that cannot help block on the future instead of polling the queue
+     */
+    virtual bool can_help() const {
+        return false;
+    }
+};
+
+template <typename T> class Future;
+template <typename T> class Promise;
+
+namespace detail {
+
+struct Unit {};
+
+template <typename T>
+struct FutureStorage {
+    using type = T;
+};
+
+template <>
+struct FutureStorage<void> {
+    using type = Unit;
+};
+
+// Shared state between one Promise and one Future
+template <typename T>
+class FutureState {
+public:
+    using Storage = typename FutureStorage<T>::type;
+    using Callback = std::function<void()>;
+
+    // A raw executor is not owned, the aliasing shared_ptr only carries the pointer
+    explicit FutureState(Executor* executor) : executor_(std::shared_ptr<Executor>(), executor) {}
+    explicit FutureState(std::shared_ptr<Executor> executor) : executor_(std::move(executor)) {}
+
+    template <typename... Args>
+    void set_value(Args&&... args) {
+        complete([&]() { value_.emplace(std::forward<Args>(args)...); });
+    }
+
+    void set_exception(std::exception_ptr error) {
+        complete([&]() { error_ = std::move(error); });
+    }
+
+    bool is_ready() const {
+        return ready_.load(std::memory_order_acquire);
+    }
+
+    // Runs queued tasks of the executor while not ready, so a pool worker waiting on its own pool cannot deadlock.
+    // A ready state never touches the executor, which may be gone by then.
+    void wait() {
+        if(is_ready()) {
+            return;
+        }
+        auto ready = [this]() { return ready_.load(std::memory_order_relaxed); };
+        if(!executor_ || !executor_->can_help()) {
+            std::unique_lock<std::mutex> ul(mtx_);
+            cv_.wait(ul, ready);
+            return;
+        }
+        while(!is_ready()) {
+            if(executor_->run_pending_task()) {
+                continue;
+            }
+            std::unique_lock<std::mutex> ul(mtx_);
+            // New tasks do not wake us, poll the queue again shortly
+            cv_.wait_for(ul, std::chrono::microseconds(100), ready);
+        }
+    }
+
+    template <typename Rep, typename Period>
+    bool wait_for(const std::chrono::duration<Rep, Period>& timeout) {
+        if(is_ready()) {
+            return true;
+        }
+        std::unique_lock<std::mutex> ul(mtx_);
+        return cv_.wait_for(ul, timeout, [this]() { return ready_.load(std::memory_order_relaxed); });
+    }
+
+    // Runs callback inline on the completing thread, or right away if already complete
+    void on_ready(Callback callback) {
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            if(!ready_.load(std::memory_order_relaxed)) {
+                callbacks_.push_back(std::move(callback));
+                return;
+            }
+        }
+        callback();
+    }
+
+    Storage take() {
+        if(error_) {
+            std::rethrow_exception(error_);
+        }
+        return std::move(*value_);
+    }
+
+    bool has_error() const {
+        return static_cast<bool>(error_);
+    }
+
+    std::exception_ptr error() const {
+        return error_;
+    }
+
+    Executor* executor() const {
+        return executor_.get();
+    }
+
+    const std::shared_ptr<Executor>& executor_handle() const {
+        return executor_;
+    }
+
+private:
+    template <typename Setter>
+    void complete(Setter&& setter) {
+        std::vector<Callback> callbacks;
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            if(ready_.load(std::memory_order_relaxed)) {
+                throw std::logic_error("promise already satisfied");
+            }
+            setter();
+            ready_.store(true, std::memory_order_release);
+            callbacks.swap(callbacks_);
+        }
+        cv_.notify_all();
+        for(auto& callback : callbacks) {
+            callback();
+        }
+    }
+
+    std::shared_ptr<Executor> executor_;  // Owning only for executors shared with their futures, e.g. a Strand
+    std::atomic<bool> ready_{false};
+    std::optional<Storage> value_;
+    std::exception_ptr error_;
+    std::mutex mtx_;
+    std::condition_variable cv_;
+    std::vector<Callback> callbacks_;
+};
+
+// Post to executor, fall back to inline execution if there is none or it refuses (e.g. stopped)
+inline void schedule_on(Executor* executor, std::function<void()> task) {
+    if(executor) {
+        try {
+            executor->post(task);
+            return;
+        } catch (const std::exception&) {
+        }
+    }
+    task();
+}
+
+// Invoke f with the value of state (or nothing for void) and fulfil promise with the result
+template <typename T, typename F, typename R>
+void invoke_continuation(FutureState<T>& state, F& f, Promise<R>& promise);
+
+}  // namespace detail
+
+/**
+ * @brief Producer side of a Future
+ * @tparam T Value type, may be void
+ */
+template <typename T>
+class Promise {
+public:
+    /**
+     * @brief Construct a promise
+     * @param executor Where continuations of the future run, nullptr runs them on the completing thread
+     */
+    explicit Promise(Executor* executor = nullptr)
+        : state_(std::make_shared<detail::FutureState<T>>(executor)) {}
+
+    /**
+     * @brief Construct a promise whose future and its continuations keep the executor alive
+     * @param executor Shared executor, e.g. the queue of a Strand that may be destroyed before the future
+     */
+    explicit Promise(std::shared_ptr<Executor> executor)
+        : state_(std::make_shared<detail::FutureState<T>>(std::move(executor))) {}
+
+    Promise(Promise&&) noexcept = default;
+    Promise& operator=(Promise&&) noexcept = default;
+    Promise(const Promise&) = delete;
+    Promise& operator=(const Promise&) = delete;
+
+    ~Promise() {
+        if(state_ && !state_->is_ready() && retrieved_) {
+            state_->set_exception(std::make_exception_ptr(std::future_error(std::future_errc::broken_promise)));
+        }
+    }
+
+    /**
+     * @brief Get the future bound to this promise, may be called once
+     */
+    Future<T> get_future() {
+        if(retrieved_) {
+            throw std::future_error(std::future_errc::future_already_retrieved);
+        }
+        retrieved_ = true;
+        return Future<T>(state_);
+    }
+
+    template <typename... Args>
+    void set_value(Args&&... args) {
+        state_->set_value(std::forward<Args>(args)...);
+    }
+
+    void set_exception(std::exception_ptr error) {
+        state_->set_exception(std::move(error));
+    }
+
+private:
+    std::shared_ptr<detail::FutureState<T>> state_;
+    bool retrieved_ = false;
+};
+
+/**
+ * @brief Future whose continuations are scheduled onto an Executor instead of blocking a thread
+ * @tparam T Value type, may be void
+ * @note Single consumer: get() and then() consume the future
+ */
+template <typename T>
+class Future {
+public:
+    Future() = default;
+    Future(Future&&) noexcept = default;
+    Future& operator=(Future&&) noexcept = default;
+    Future(const Future&) = delete;
+    Future& operator=(const Future&) = delete;
+
+    bool valid() const {
+        return static_cast<bool>(state_);
+    }
+
+    /**
+     * @brief Check if a value or exception is available (non-blocking)
+     */
+    bool is_ready() const {
+        check_valid();
+        return state_->is_ready();
+    }
+
+    /**
+     * @brief Block until the value or exception is available
+     * @note On a worker of the future's pool, queued tasks of that pool run while waiting.
+     *       Waiting on a future that is not ready yet requires its executor to be alive.
+     */
+    void wait() const {
+        check_valid();
+        state_->wait();
+    }
+
+    /**
+     * @brief Block until ready or timeout
+     * @return true if ready
+     */
+    template <typename Rep, typename Period>
+    bool wait_for(const std::chrono::duration<Rep, Period>& timeout) const {
+        check_valid();
+        return state_->wait_for(timeout);
+    }
+
+    /**
+     * @brief Wait and take the value, rethrows the stored exception
+     * @note Helps the pool like wait(), nested get() on a worker does not lose the worker.
+     *       A ready future can be taken after its executor is destroyed.
+     */
+    T get() {
+        check_valid();
+        state_->wait();
+        auto state = std::move(state_);
+        if constexpr (std::is_void<T>::value) {
+            state->take();
+        } else {
+            return state->take();
+        }
+    }
+
+    /**
+     * @brief Attach a continuation that runs on the future's executor once the value is ready
+     * @param f Callable taking T (nothing for void), an exception skips f and propagates
+     * @return Future of f's result
+     */
+    template <typename F>
+    auto then(F&& f) {
+        check_valid();
+        using R = typename ContinuationResult<F>::type;
+        return continue_with(Promise<R>(state_->executor_handle()), std::forward<F>(f));
+    }
+
+    /**
+     * @brief Attach a continuation that runs on the given executor
+     * @param executor Executor for f, nullptr runs f on the completing thread
+     * @param f Callable taking T (nothing for void)
+     * @return Future of f's result
+     */
+    template <typename F>
+    auto then(Executor* executor, F&& f) {
+        check_valid();
+        using R = typename ContinuationResult<F>::type;
+        return continue_with(Promise<R>(executor), std::forward<F>(f));
+    }
+
+    /**
+     * @brief Register a low-level callback that runs on the completing thread once ready
+     * @param callback Callback, runs immediately if already ready; the future stays valid
+     */
+    void on_ready(std::function<void()> callback) const {
+        check_valid();
+        state_->on_ready(std::move(callback));
+    }
+
+    Executor* executor() const {
+        return state_ ? state_->executor() : nullptr;
+    }
+
+private:
+    template <typename U> friend class Promise;
+    template <typename U> friend class Future;
+    template <typename U> friend auto when_all(std::vector<Future<U>> futures);
+    template <typename U> friend auto when_any(std::vector<Future<U>> futures);
+    template <typename... Ts> friend auto when_all(Future<Ts>&&... futures);
+
+    // Schedule f onto the executor of promise once ready, promise receives f's result
+    template <typename R, typename F>
+    Future<R> continue_with(Promise<R> promise, F&& f) {
+        auto result = promise.get_future();
+        Executor* executor = result.executor();
+        auto state = std::move(state_);
+        auto shared = std::make_shared<std::tuple<std::decay_t<F>, Promise<R>>>(
+            std::forward<F>(f), std::move(promise));
+        auto* raw = state.get();
+        raw->on_ready([state, shared, executor]() {
+            detail::schedule_on(executor, [state, shared]() {
+                detail::invoke_continuation(*state, std::get<0>(*shared), std::get<1>(*shared));
+            });
+        });
+        return result;
+    }
+
+    std::shared_ptr<Executor> executor_handle() const {
+        return state_ ? state_->executor_handle() : nullptr;
+    }
+
+    template <typename F, bool Void = std::is_void<T>::value>
+    struct ContinuationResult {
+        using type = std::invoke_result_t<std::decay_t<F>&, T>;
+    };
+
+    template <typename F>
+    struct ContinuationResult<F, true> {
+        using type = std::invoke_result_t<std::decay_t<F>&>;
+    };
+
+    explicit Future(std::shared_ptr<detail::FutureState<T>> state) : state_(std::move(state)) {}
+
+    void check_valid() const {
+        if(!state_) {
+            throw std::future_error(std::future_errc::no_state);
+        }
+    }
+
+    std::shared_ptr<detail::FutureState<T>> state_;
+};
+
+namespace detail {
+
+template <typename T, typename F, typename R>
+void invoke_continuation(FutureState<T>& state, F& f, Promise<R>& promise) {
+    if(state.has_error()) {
+        promise.set_exception(state.error());
+        return;
+    }
+    try {
+        if constexpr (std::is_void<T>::value) {
+            if constexpr (std::is_void<R>::value) {
+                f();
+                promise.set_value();
+            } else {
+                promise.set_value(f());
+            }
+        } else {
+            if constexpr (std::is_void<R>::value) {
+                f(state.take());
+                promise.set_value();
+            } else {
+                promise.set_value(f(state.take()));
+            }
+        }
+    } catch (...) {
+        promise.set_exception(std::current_exception());
+    }
+}
+
+// Run task and store its result or exception in promise
+template <typename R, typename Task>
+void fulfil(Promise<R>& promise, Task& task) {
+    try {
+        if constexpr (std::is_void<R>::value) {
+            task();
+            promise.set_value();
+        } else {
+            promise.set_value(task());
+        }
+    } catch (...) {
+        promise.set_exception(std::current_exception());
+    }
+}
+
+}  // namespace detail
+
+/**
+ * @brief Make an already fulfilled future
+ */
+template <typename T>
+Future<std::decay_t<T>> make_ready_future(T&& value, Executor* executor = nullptr) {
+    Promise<std::decay_t<T>> promise(executor);
+    auto future = promise.get_future();
+    promise.set_value(std::forward<T>(value));
+    return future;
+}
+
+inline Future<void> make_ready_future(Executor* executor = nullptr) {
+    Promise<void> promise(executor);
+    auto future = promise.get_future();
+    promise.set_value();
+    return future;
+}
+
+/**
+ * @brief Result of when_any
+ */
+template <typename T>
+struct WhenAnyResult {
+    size_t index;                   // Index of the first ready future
+    std::vector<Future<T>> futures; // All input futures, futures[index] is ready
+};
+
+/**
+ * @brief Future that becomes ready when all inputs are ready
+ * @param futures Input futures, consumed
+ * @return Future of the (ready) input futures, continuations run on the first input's executor
+ */
+template <typename T>
+auto when_all(std::vector<Future<T>> futures) {
+    std::shared_ptr<Executor> executor = futures.empty() ? nullptr : futures.front().executor_handle();
+    struct Context {
+        std::vector<Future<T>> futures;
+        std::atomic<size_t> remaining;
+        Promise<std::vector<Future<T>>> promise;
+        Context(std::vector<Future<T>>&& f, std::shared_ptr<Executor> e)
+            : futures(std::move(f)), remaining(futures.size()), promise(std::move(e)) {}
+    };
+    auto context = std::make_shared<Context>(std::move(futures), executor);
+    auto result = context->promise.get_future();
+    if(context->futures.empty()) {
+        context->promise.set_value(std::vector<Future<T>>());
+        return result;
+    }
+    for(auto& future : context->futures) {
+        future.check_valid();
+        future.state_->on_ready([context]() {
+            if(context->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                context->promise.set_value(std::move(context->futures));
+            }
+        });
+    }
+    return result;
+}
+
+/**
+ * @brief Future that becomes ready when all inputs are ready
+ * @param futures Input futures of possibly different types, consumed
+ * @return Future of a tuple of the (ready) input futures
+ */
+template <typename... Ts>
+auto when_all(Future<Ts>&&... futures) {
+    using Tuple = std::tuple<Future<Ts>...>;
+    std::shared_ptr<Executor> executor;
+    for(const auto& e : {futures.executor_handle()...}) {
+        if(e) {
+            executor = e;
+            break;
+        }
+    }
+    struct Context {
+        Tuple futures;
+        std::atomic<size_t> remaining{sizeof...(Ts)};
+        Promise<Tuple> promise;
+        Context(Tuple&& f, std::shared_ptr<Executor> e) : futures(std::move(f)), promise(std::move(e)) {}
+    };
+    auto context = std::make_shared<Context>(Tuple(std::move(futures)...), executor);
+    auto result = context->promise.get_future();
+    std::apply([&context](auto&... future) {
+        (future.state_->on_ready([context]() {
+            if(context->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                context->promise.set_value(std::move(context->futures));
+            }
+        }), ...);
+    }, context->futures);
+    return result;
+}
+
+/**
+ * @brief Future that becomes ready when the first input is ready
+ * @param futures Input futures, consumed
+ * @return Future of WhenAnyResult, continuations run on the first input's executor
+ * @throws std::invalid_argument if futures is empty
+ */
+template <typename T>
+auto when_any(std::vector<Future<T>> futures) {
+    if(futures.empty()) {
+        throw std::invalid_argument("when_any on empty futures");
+    }
+    std::shared_ptr<Executor> executor = futures.front().executor_handle();
+    struct Context {
+        std::vector<Future<T>> futures;
+        std::atomic<bool> done{false};
+        Promise<WhenAnyResult<T>> promise;
+        Context(std::vector<Future<T>>&& f, std::shared_ptr<Executor> e) : futures(std::move(f)), promise(std::move(e)) {}
+    };
+    auto context = std::make_shared<Context>(std::move(futures), executor);
+    auto result = context->promise.get_future();
+    // Keep the states alive here: the first ready callback moves the futures out of context
+    std::vector<std::shared_ptr<detail::FutureState<T>>> states;
+    for(auto& future : context->futures) {
+        future.check_valid();
+        states.push_back(future.state_);
+    }
+    for(size_t i = 0; i < states.size(); ++i) {
+        states[i]->on_ready([context, i]() {
+            if(!context->done.exchange(true, std::memory_order_acq_rel)) {
+                context->promise.set_value(WhenAnyResult<T>{i, std::move(context->futures)});
+            }
+        });
+    }
+    return result;
+}
+
+#endif // __FUTURE_H__
@@ -64,37 +64,37 @@ public:
 
     template <typename... Args>
     inline void log_critical(const char *fmt, Args... args){
-        if (main_logger_) main_logger_->critical(fmt, args...); else SPDLOG_CRITICAL(fmt, args...);
+        if (main_logger_) main_logger_->critical(fmt::runtime(fmt), args...); else SPDLOG_CRITICAL(fmt::runtime(fmt), args...);
     }
 
     template <typename... Args>
     inline void log_error(const char *fmt, Args... args) {
-        if (main_logger_) main_logger_->error(fmt, args...); else SPDLOG_ERROR(fmt, args...);
+        if (main_logger_) main_logger_->error(fmt::runtime(fmt), args...); else SPDLOG_ERROR(fmt::runtime(fmt), args...);
     }
 
     template <typename... Args>
     inline void log_warn(const char *fmt, Args... args) {
-        if (main_logger_) main_logger_->warn(fmt, args...); else SPDLOG_WARN(fmt, args...);
+        if (main_logger_) main_logger_->warn(fmt::runtime(fmt), args...); else SPDLOG_WARN(fmt::runtime(fmt), args...);
     }
 
     template <typename... Args>
     inline void log_info(const char *fmt, Args... args) {
-        if (main_logger_) main_logger_->info(fmt, args...); else SPDLOG_INFO(fmt, args...);
+        if (main_logger_) main_logger_->info(fmt::runtime(fmt), args...); else SPDLOG_INFO(fmt::runtime(fmt), args...);
     }
 
     template <typename... Args>
     inline void log_debug(const char *fmt, Args... args) {
-        if (main_logger_) main_logger_->debug(fmt, args...); else SPDLOG_DEBUG(fmt, args...);
+        if (main_logger_) main_logger_->debug(fmt::runtime(fmt), args...); else SPDLOG_DEBUG(fmt::runtime(fmt), args...);
     }
 
     template <typename... Args>
     inline void log_trace(const char *fmt, Args... args) {
-        if (main_logger_) main_logger_->trace(fmt, args...); else SPDLOG_TRACE(fmt, args...);
+        if (main_logger_) main_logger_->trace(fmt::runtime(fmt), args...); else SPDLOG_TRACE(fmt::runtime(fmt), args...);
     }
 
     template <typename... Args>
     inline void log_time(const char *fmt, Args... args) {
-        if (time_logger_) time_logger_->info(fmt, args...);
+        if (time_logger_) time_logger_->info(fmt::runtime(fmt), args...);
     }
 
 private:
@@ -0,0 +1,293 @@
+#ifndef __MPMC_QUEUE_H__
+#define __MPMC_QUEUE_H__
+
+#include "thread_utils.hpp"
+
+#include <atomic>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <thread>
+#include <utility>
+
+/**
+ * @brief Bounded lock-free multi-producer multi-consumer queue with the SafeQueue interface
+ * @tparam T Type of elements stored in the queue
+ * @note Vyukov's ring: every slot carries a sequence number telling producers and consumers whose
+ *       turn it is, so each operation is one CAS on the shared position plus an uncontended slot.
+ *       The ring is rounded up to a power of two (at least 2) for masking, push() still fails at exactly
+ *       cap elements. pop() spins and yields briefly, then sleeps on a futex; producers only make a
+ *       syscall when a consumer is asleep.
+ */
+template <typename T>
+class MpmcQueue
+{
+public:
+    explicit MpmcQueue(size_t cap = 200)
+        : capacity_(cap),
+          ring_size_(round_up_pow2(cap < 2 ? 2 : cap)),
+          mask_(ring_size_ - 1),
+          cells_(new Cell[ring_size_])
+    {
+        for (size_t i = 0; i < ring_size_; ++i)
+        {
+            cells_[i].seq.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MpmcQueue(const MpmcQueue &) = delete;
+    MpmcQueue &operator=(const MpmcQueue &) = delete;
+
+    ~MpmcQueue()
+    {
+        stop();
+        clear();
+    }
+
+    /**
+     * @brief Push element to queue
+     * @param value Element to push
+     * @return true if push succeeded, false if queue is full
+     */
+    bool push(const T &value)
+    {
+        return emplace(value);
+    }
+
+    bool push(T &&value)
+    {
+        return emplace(std::move(value));
+    }
+
+    /**
+     * @brief Try to pop element from queue (non-blocking)
+     * @param value Output parameter for popped element
+     * @return true if pop succeeded, false if queue is empty
+     */
+    bool try_pop(T &value)
+    {
+        return dequeue([&value](T &slot) { value = std::move(slot); });
+    }
+
+    /**
+     * @brief Pop element from queue (blocking)
+     * @param value Output parameter for popped element
+     * @return true if pop succeeded, false if stopped
+     * @note Blocks until data is available or stop() is called
+     */
+    bool pop(T &value)
+    {
+        static const int spin = std::thread::hardware_concurrency() > 1 ? kSpin : 0;
+        for (int i = 0; i < spin + kYield; ++i)
+        {
+            if (stopped_.load(std::memory_order_acquire))
+            {
+                return false;
+            }
+            if (try_pop(value))
+            {
+                return true;
+            }
+            if (i < spin)
+            {
+                cpu_relax();
+            }
+            else
+            {
+                std::this_thread::yield();
+            }
+        }
+        for (;;)
+        {
+            if (stopped_.load(std::memory_order_acquire))
+            {
+                return false;
+            }
+            uint32_t seq = wake_seq_.load(std::memory_order_acquire);
+            waiters_.fetch_add(1, std::memory_order_relaxed);
+            // Pairs with the fence in emplace(): either we see the element or the producer sees a waiter
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            bool popped = try_pop(value);
+            if (!popped && !stopped_.load(std::memory_order_acquire))
+            {
+                futex_wait(wake_seq_, seq);
+            }
+            waiters_.fetch_sub(1, std::memory_order_relaxed);
+            if (popped)
+            {
+                return true;
+            }
+        }
+    }
+
+    /**
+     * @brief Stop queue operations, wakes every consumer blocked in pop()
+     */
+    void stop()
+    {
+        if (stopped_.exchange(true, std::memory_order_acq_rel))
+        {
+            return;
+        }
+        wake_seq_.fetch_add(1, std::memory_order_release);
+        futex_wake(wake_seq_, INT_MAX);
+    }
+
+    /**
+     * @brief Clear all elements in queue
+     */
+    void clear()
+    {
+        while (dequeue([](T &) {}))
+        {
+        }
+    }
+
+    /**
+     * @brief Get current queue size
+     * @return Number of elements in queue, a snapshot when called concurrently
+     */
+    size_t size() const
+    {
+        size_t head = dequeue_pos_.load(std::memory_order_acquire);
+        size_t tail = enqueue_pos_.load(std::memory_order_acquire);
+        return tail > head ? tail - head : 0;
+    }
+
+    /**
+     * @brief Check if queue is empty
+     * @return true if empty, false otherwise
+     */
+    bool empty() const
+    {
+        return size() == 0;
+    }
+
+    /**
+     * @brief Get the capacity passed to the constructor
+     */
+    size_t capacity() const
+    {
+        return capacity_;
+    }
+
+private:
+    static constexpr int kSpin = 256;
+    static constexpr int kYield = 8;
+
+    struct Cell
+    {
+        std::atomic<size_t> seq;
+        alignas(T) unsigned char storage[sizeof(T)];
+
+        T *ptr()
+        {
+            return std::launder(reinterpret_cast<T *>(storage));
+        }
+    };
+
+    static size_t round_up_pow2(size_t value)
+    {
+        size_t result = 1;
+        while (result < value)
+        {
+            result <<= 1;
+        }
+        return result;
+    }
+
+    // Claim the next full cell, hand its element to consume, then release the cell to producers
+    template <typename F>
+    bool dequeue(F &&consume)
+    {
+        size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+        Cell *cell;
+        for (;;)
+        {
+            cell = &cells_[pos & mask_];
+            size_t seq = cell->seq.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+            if (diff == 0)
+            {
+                if (dequeue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (diff < 0)
+            {
+                return false;
+            }
+            else
+            {
+                pos = dequeue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+        T *slot = cell->ptr();
+        consume(*slot);
+        slot->~T();
+        cell->seq.store(pos + ring_size_, std::memory_order_release);
+        return true;
+    }
+
+    template <typename U>
+    bool emplace(U &&value)
+    {
+        size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+        Cell *cell;
+        for (;;)
+        {
+            // The ring is larger than requested: also bound by positions. dequeue_pos_ only grows, so a
+            // stale value can only make the queue look fuller, never let it exceed capacity_.
+            if (ring_size_ != capacity_)
+            {
+                size_t head = dequeue_pos_.load(std::memory_order_acquire);
+                if (pos >= head && pos - head >= capacity_)
+                {
+                    return false;
+                }
+            }
+            cell = &cells_[pos & mask_];
+            size_t seq = cell->seq.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0)
+            {
+                if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (diff < 0)
+            {
+                return false;
+            }
+            else
+            {
+                pos = enqueue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+        new (cell->storage) T(std::forward<U>(value));
+        cell->seq.store(pos + 1, std::memory_order_release);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiters_.load(std::memory_order_relaxed) > 0)
+        {
+            wake_seq_.fetch_add(1, std::memory_order_release);
+            futex_wake(wake_seq_, 1);
+        }
+        return true;
+    }
+
+    const size_t capacity_;
+    const size_t ring_size_;
+    const size_t mask_;
+    std::unique_ptr<Cell[]> cells_;
+    alignas(64) std::atomic<size_t> enqueue_pos_{0};
+    alignas(64) std::atomic<size_t> dequeue_pos_{0};
+    alignas(64) std::atomic<uint32_t> wake_seq_{0};
+    std::atomic<int> waiters_{0};
+    std::atomic<bool> stopped_{false};
+};
+
+#endif // __MPMC_QUEUE_H__
@@ -0,0 +1,263 @@
+#ifndef __QUEUE_STATS_H__
+#define __QUEUE_STATS_H__
+
+#include "singleton.hpp"
+#include "thread_pool_metrics.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Stats policy of SafeQueue that records nothing, every hook compiles away
+ */
+struct NoQueueStats {
+    static constexpr bool kEnabled = false;
+
+    void on_push(size_t) {}
+    void on_reject() {}
+    void on_evict() {}
+    void on_pop(size_t) {}
+    void on_wait(uint64_t) {}
+};
+
+/**
+ * @brief Point-in-time copy of a queue's counters, see QueueStats::snapshot()
+ * @note Counters are cumulative; diff two snapshots to get rates
+ */
+struct QueueStatsSnapshot {
+    uint64_t pushes = 0;      // Elements accepted
+    uint64_t pops = 0;        // Elements handed to consumers
+    uint64_t rejected = 0;    // Pushes refused because the queue was full
+    uint64_t evicted = 0;     // Elements dropped by OverflowPolicy::OverwriteOldest
+    uint64_t high_water = 0;  // Largest element count seen
+    size_t size = 0;          // Element count when the snapshot was taken, filled in by QueueRegistry
+    HistogramSnapshot wait;   // Time blocked in pop()/pop_until()/pop_batch(), pops that found data are not recorded
+};
+
+/**
+ * @brief Stats policy of SafeQueue that counts traffic, usable as SafeQueue<T, QueueStats>
+ * @note Hooks run under the queue mutex, so writes are serialised and readers never lock
+ */
+class QueueStats {
+public:
+    static constexpr bool kEnabled = true;
+
+    void on_push(size_t size) {
+        detail::single_writer_add(pushes_, 1);
+        if (size > high_water_.load(std::memory_order_relaxed)) {
+            high_water_.store(size, std::memory_order_relaxed);
+        }
+    }
+
+    void on_reject() {
+        detail::single_writer_add(rejected_, 1);
+    }
+
+    void on_evict() {
+        detail::single_writer_add(evicted_, 1);
+    }
+
+    void on_pop(size_t count) {
+        detail::single_writer_add(pops_, count);
+    }
+
+    void on_wait(uint64_t ns) {
+        wait_.record(ns);
+    }
+
+    QueueStatsSnapshot snapshot() const {
+        QueueStatsSnapshot s;
+        s.pushes = pushes_.load(std::memory_order_relaxed);
+        s.pops = pops_.load(std::memory_order_relaxed);
+        s.rejected = rejected_.load(std::memory_order_relaxed);
+        s.evicted = evicted_.load(std::memory_order_relaxed);
+        s.high_water = high_water_.load(std::memory_order_relaxed);
+        s.wait = wait_.snapshot();
+        return s;
+    }
+
+private:
+    std::atomic<uint64_t> pushes_{0};
+    std::atomic<uint64_t> pops_{0};
+    std::atomic<uint64_t> rejected_{0};
+    std::atomic<uint64_t> evicted_{0};
+    std::atomic<uint64_t> high_water_{0};
+    LatencyHistogram wait_;
+};
+
+/**
+ * @brief Named queues whose stats are dumped together to find the bottleneck
+ *
+ *   SafeQueue<Image, QueueStats> images(8);
+ *   auto reg = Singleton<QueueRegistry>::instance().add("camera/images", images);
+ *   Singleton<QueueRegistry>::instance().start_dump(std::chrono::seconds(5),
+ *                                                   [](const std::string& text) { LOGI("{}", text); });
+ */
+class QueueRegistry {
+public:
+    /**
+     * @brief Keeps a queue registered, removes it when destroyed
+     * @note Keep it next to the queue so the queue is never dumped after its destruction
+     */
+    class Registration {
+    public:
+        Registration() = default;
+        Registration(QueueRegistry* registry, uint64_t id) : registry_(registry), id_(id) {}
+
+        Registration(Registration&& other) noexcept : registry_(other.registry_), id_(other.id_) {
+            other.registry_ = nullptr;
+        }
+
+        Registration& operator=(Registration&& other) noexcept {
+            if (this != &other) {
+                reset();
+                registry_ = other.registry_;
+                id_ = other.id_;
+                other.registry_ = nullptr;
+            }
+            return *this;
+        }
+
+        ~Registration() {
+            reset();
+        }
+
+        void reset() {
+            if (registry_) {
+                registry_->remove(id_);
+                registry_ = nullptr;
+            }
+        }
+
+    private:
+        QueueRegistry* registry_ = nullptr;
+        uint64_t id_ = 0;
+    };
+
+    QueueRegistry() = default;
+
+    ~QueueRegistry() {
+        stop_dump();
+    }
+
+    QueueRegistry(const QueueRegistry&) = delete;
+    QueueRegistry& operator=(const QueueRegistry&) = delete;
+
+    /**
+     * @brief Register a queue with stats, e.g. SafeQueue<T, QueueStats>
+     * @param name Name shown in dumps, need not be unique
+     * @param queue Queue to sample, must outlive the returned registration
+     */
+    template <typename Queue>
+    [[nodiscard]] Registration add(const std::string& name, const Queue& queue) {
+        static_assert(Queue::Stats::kEnabled, "register a queue built with a stats policy such as QueueStats");
+        std::lock_guard<std::mutex> lock(mtx_);
+        uint64_t id = next_id_++;
+        entries_.push_back(Entry{id, name, [&queue]() {
+                                     QueueStatsSnapshot s = queue.stats().snapshot();
+                                     s.size = queue.size();
+                                     return s;
+                                 }});
+        return Registration(this, id);
+    }
+
+    /**
+     * @brief Sample every registered queue
+     */
+    std::vector<std::pair<std::string, QueueStatsSnapshot>> snapshot() const {
+        std::lock_guard<std::mutex> lock(mtx_);
+        std::vector<std::pair<std::string, QueueStatsSnapshot>> result;
+        result.reserve(entries_.size());
+        for (const auto& entry : entries_) {
+            result.emplace_back(entry.name, entry.sample());
+        }
+        return result;
+    }
+
+    /**
+     * @brief Format every registered queue as one table, one line per queue
+     */
+    std::string dump() const {
+        std::string text;
+        char line[256];
+        std::snprintf(line, sizeof(line), "%-24s %8s %8s %12s %12s %10s %10s %10s %12s\n", "queue", "size",
+                      "high", "pushes", "pops", "rejected", "evicted", "waits", "wait_p99_us");
+        text += line;
+        for (const auto& item : snapshot()) {
+            const QueueStatsSnapshot& s = item.second;
+            std::snprintf(line, sizeof(line), "%-24s %8zu %8llu %12llu %12llu %10llu %10llu %10llu %12.1f\n",
+                          item.first.c_str(), s.size, static_cast<unsigned long long>(s.high_water),
+                          static_cast<unsigned long long>(s.pushes), static_cast<unsigned long long>(s.pops),
+                          static_cast<unsigned long long>(s.rejected), static_cast<unsigned long long>(s.evicted),
+                          static_cast<unsigned long long>(s.wait.count), s.wait.percentile_ns(0.99) / 1000.0);
+            text += line;
+        }
+        return text;
+    }
+
+    /**
+     * @brief Pass dump() to sink every period on a background thread, replaces a running dump
+     */
+    void start_dump(std::chrono::milliseconds period, std::function<void(const std::string&)> sink) {
+        stop_dump();
+        std::lock_guard<std::mutex> lock(dump_mtx_);
+        dumping_ = true;
+        dump_thread_ = std::thread([this, period, sink = std::move(sink)]() {
+            std::unique_lock<std::mutex> ul(dump_mtx_);
+            while (!dump_cv_.wait_for(ul, period, [this]() { return !dumping_; })) {
+                ul.unlock();
+                sink(dump());
+                ul.lock();
+            }
+        });
+    }
+
+    void stop_dump() {
+        {
+            std::lock_guard<std::mutex> lock(dump_mtx_);
+            dumping_ = false;
+        }
+        dump_cv_.notify_all();
+        if (dump_thread_.joinable()) {
+            dump_thread_.join();
+        }
+    }
+
+private:
+    struct Entry {
+        uint64_t id;
+        std::string name;
+        std::function<QueueStatsSnapshot()> sample;
+    };
+
+    void remove(uint64_t id) {
+        std::lock_guard<std::mutex> lock(mtx_);
+        for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+            if (it->id == id) {
+                entries_.erase(it);
+                return;
+            }
+        }
+    }
+
+    mutable std::mutex mtx_;
+    std::vector<Entry> entries_;
+    uint64_t next_id_ = 0;
+
+    std::mutex dump_mtx_;
+    std::condition_variable dump_cv_;
+    bool dumping_ = false;
+    std::thread dump_thread_;
+};
+
+#endif // __QUEUE_STATS_H__
@@ -9,47 +9,154 @@
 #ifndef __SAFE_QUEUE_H__
 #define __SAFE_QUEUE_H__
 
-#include <queue>
+#include "queue_stats.hpp"
+
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdint>
+#include <memory>
 #include <mutex>
 #include <condition_variable>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <system_error>
+#include <utility>
+
+/**
+ * @brief What SafeQueue::push does when the queue is full
+ */
+enum class OverflowPolicy
+{
+    Reject,          // push returns false, the new element is dropped
+    OverwriteOldest, // the oldest element is evicted, consumers always see the newest elements
+};
 
 /**
  * @brief Thread-safe queue with capacity limit
  * @tparam T Type of elements stored in the queue
+ * @tparam StatsPolicy NoQueueStats (default, no overhead) or QueueStats to count traffic, see stats()
+ * @note Elements live in a ring preallocated for the full capacity, push never allocates.
+ *       An optional byte budget additionally bounds the memory held by variable-size elements.
  */
-template <typename T>
+template <typename T, typename StatsPolicy = NoQueueStats>
 class SafeQueue
 {
 public:
-    explicit SafeQueue(size_t cap = 200)
+    using Stats = StatsPolicy;
+
+    explicit SafeQueue(size_t cap = 200, OverflowPolicy policy = OverflowPolicy::Reject)
         : capacity_(cap),
+          policy_(policy),
+          buffer_(std::allocator<T>().allocate(cap)),
           stopped_(false)
     {
     }
 
+    /**
+     * @brief Queue bounded by both element count and total bytes
+     * @param cap Maximum number of elements, the ring is preallocated for it
+     * @param max_bytes Maximum sum of size_of over the queued elements
+     * @param size_of Returns the bytes held by an element, e.g. the encoded size of a frame
+     * @param policy OverflowPolicy::OverwriteOldest evicts the oldest elements until the new one fits
+     * @note An element larger than max_bytes on its own is always rejected
+     */
+    SafeQueue(size_t cap, size_t max_bytes, std::function<size_t(const T &)> size_of,
+              OverflowPolicy policy = OverflowPolicy::Reject)
+        : SafeQueue(cap, policy)
+    {
+        max_bytes_ = max_bytes;
+        size_of_ = std::move(size_of);
+        if (size_of_)
+        {
+            sizes_.resize(cap);
+        }
+    }
+
+    SafeQueue(const SafeQueue &) = delete;
+    SafeQueue &operator=(const SafeQueue &) = delete;
+
     ~SafeQueue()
     {
         stop();
+        clear();
+        std::allocator<T>().deallocate(buffer_, capacity_);
+        if (event_fd_ != -1)
+        {
+            ::close(event_fd_);
+        }
     }
 
     /**
      * @brief Push element to queue
      * @param value Element to push
-     * @return true if push succeeded, false if queue is full
+     * @return true if push succeeded, false if queue is full and the policy is OverflowPolicy::Reject
      */
     bool push(const T &value)
     {
+        return push_one(value);
+    }
+
+    bool push(T &&value)
+    {
+        return push_one(std::move(value));
+    }
+
+    /**
+     * @brief Construct element in place at the tail of the queue
+     * @param args Arguments forwarded to the constructor of T
+     * @return true if push succeeded, false if queue is full and the policy is OverflowPolicy::Reject
+     * @note Nothing is constructed when the queue is full. With a byte budget the element is built
+     *       outside the lock and measured before anything is evicted, then moved in.
+     */
+    template <typename... Args>
+    bool emplace(Args &&...args)
+    {
+        if (size_of_)
+        {
+            return push_one(T(std::forward<Args>(args)...));
+        }
+
         std::lock_guard<std::mutex> lock(mutex_);
-        if (queue_.size() >= capacity_)
+        if (!emplace_locked(0, std::forward<Args>(args)...))
         {
             return false;
         }
 
-        queue_.push(value);
         cv_.notify_one();
         return true;
     }
 
+    /**
+     * @brief Push a range of elements under one lock acquisition
+     * @param first Begin of the range, use std::make_move_iterator to move the elements
+     * @param last End of the range
+     * @return Number of elements pushed, stops early when the queue is full and the policy is OverflowPolicy::Reject
+     */
+    template <typename InputIt>
+    size_t push_range(InputIt first, InputIt last)
+    {
+        size_t count = 0;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (; first != last && insert_locked(*first); ++first)
+            {
+                ++count;
+            }
+        }
+        if (count == 1)
+        {
+            cv_.notify_one();
+        }
+        else if (count > 1)
+        {
+            cv_.notify_all();
+        }
+        return count;
+    }
+
     /**
      * @brief Try to pop element from queue (non-blocking)
      * @param value Output parameter for popped element
@@ -58,12 +165,11 @@ public:
     bool try_pop(T &value)
     {
         std::lock_guard<std::mutex> lock(mutex_);
-        if (queue_.empty())
+        if (size_ == 0)
         {
             return false;
         }
-        value = std::move(queue_.front());
-        queue_.pop();
+        take_front(value);
         return true;
     }
 
@@ -76,18 +182,85 @@ public:
     bool pop(T &value)
     {
         std::unique_lock<std::mutex> lock(mutex_);
-        cv_.wait(lock, [this]() { return !queue_.empty() || stopped_; });
+        wait_ready(lock);
 
         if (stopped_)
         {
             return false;
         }
 
-        value = std::move(queue_.front());
-        queue_.pop();
+        take_front(value);
         return true;
     }
 
+    /**
+     * @brief Pop element from queue, waiting at most timeout
+     * @param value Output parameter for popped element
+     * @param timeout Maximum time to wait
+     * @return true if pop succeeded, false on timeout or if stopped
+     */
+    template <typename Rep, typename Period>
+    bool pop_for(T &value, const std::chrono::duration<Rep, Period> &timeout)
+    {
+        return pop_until(value, std::chrono::steady_clock::now() +
+                                    std::chrono::duration_cast<std::chrono::steady_clock::duration>(timeout));
+    }
+
+    /**
+     * @brief Pop element from queue, waiting until deadline
+     * @param value Output parameter for popped element
+     * @param deadline Time point on steady_clock, immune to wall clock changes
+     * @return true if pop succeeded, false on timeout or if stopped
+     * @note Lets a consumer run periodic work between elements without polling try_pop
+     */
+    bool pop_until(T &value, const std::chrono::steady_clock::time_point &deadline)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (!wait_ready_until(lock, deadline))
+        {
+            return false;
+        }
+
+        if (stopped_)
+        {
+            return false;
+        }
+
+        take_front(value);
+        return true;
+    }
+
+    /**
+     * @brief Pop up to max elements under one lock acquisition (blocking)
+     * @param out Elements are appended to it
+     * @param max Maximum number of elements to pop
+     * @return Number of elements popped, 0 if stopped
+     * @note Blocks until at least one element is available or stop() is called
+     */
+    size_t pop_batch(std::vector<T> &out, size_t max)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        wait_ready(lock);
+
+        if (stopped_)
+        {
+            return 0;
+        }
+
+        return take(out, max);
+    }
+
+    /**
+     * @brief Pop every queued element under one lock acquisition (non-blocking)
+     * @param out Elements are appended to it
+     * @return Number of elements popped, 0 if queue is empty
+     */
+    size_t drain(std::vector<T> &out)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return take(out, size_);
+    }
+
     /**
      * @brief Stop queue operations
      */
@@ -100,6 +273,7 @@ public:
                 return;
             }
             stopped_ = true;
+            signal_ready();
         }
         cv_.notify_all();
     }
@@ -110,10 +284,11 @@ public:
     void clear()
     {
         std::lock_guard<std::mutex> lock(mutex_);
-        while (!queue_.empty())
+        while (size_ > 0)
         {
-            queue_.pop();
+            pop_front();
         }
+        clear_ready();
     }
 
     /**
@@ -123,7 +298,7 @@ public:
     size_t size() const
     {
         std::lock_guard<std::mutex> lock(mutex_);
-        return queue_.size();
+        return size_;
     }
 
     /**
@@ -133,15 +308,292 @@ public:
     bool empty() const
     {
         std::lock_guard<std::mutex> lock(mutex_);
-        return queue_.empty();
+        return size_ == 0;
+    }
+
+    /**
+     * @brief Get the bytes held by the queued elements, 0 without a byte budget
+     */
+    size_t bytes() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return bytes_;
+    }
+
+    /**
+     * @brief Get the largest value bytes() has reached since construction
+     */
+    size_t bytes_high_water() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return bytes_high_water_;
+    }
+
+    /**
+     * @brief Get the counters of the stats policy, e.g. stats().snapshot() with QueueStats
+     * @note Register the queue with QueueRegistry to dump it periodically
+     */
+    const Stats &stats() const
+    {
+        return stats_;
+    }
+
+    /**
+     * @brief Check if stop() was called
+     */
+    bool stopped() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return stopped_;
+    }
+
+    /**
+     * @brief Get an eventfd that is readable while the queue holds elements or is stopped
+     * @return File descriptor owned by the queue, created on first call
+     * @throws std::system_error if eventfd creation fails
+     * @note Level-triggered: register it with epoll/poll (see WaitSet) and drain with try_pop() when it
+     *       fires. Never read it directly. Queues that never call this pay nothing for the signal.
+     */
+    int ready_fd()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (event_fd_ == -1)
+        {
+            event_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+            if (event_fd_ == -1)
+            {
+                throw std::system_error(errno, std::generic_category(), "eventfd");
+            }
+            if (size_ > 0 || stopped_)
+            {
+                signal_ready();
+            }
+        }
+        return event_fd_;
+    }
+
+    /**
+     * @brief Get the number of elements overwritten under OverflowPolicy::OverwriteOldest
+     * @return Evictions since construction
+     */
+    size_t evictions() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return evictions_;
     }
 
 private:
+    size_t next(size_t index) const
+    {
+        return index + 1 == capacity_ ? 0 : index + 1;
+    }
+
+    template <typename U>
+    bool push_one(U &&value)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!insert_locked(std::forward<U>(value)))
+        {
+            return false;
+        }
+
+        cv_.notify_one();
+        return true;
+    }
+
+    // Called with mutex_ held, a complete element is measured before it is copied or moved in
+    template <typename U>
+    bool insert_locked(U &&value)
+    {
+        size_t bytes = size_of_ ? size_of_(value) : 0;
+        return emplace_locked(bytes, std::forward<U>(value));
+    }
+
+    // Called with mutex_ held, bytes is the size_of of the new element (0 without a byte budget)
+    template <typename... Args>
+    bool emplace_locked(size_t bytes, Args &&...args)
+    {
+        bool was_empty = size_ == 0;
+        if (!make_room(bytes))
+        {
+            stats_.on_reject();
+            return false;
+        }
+        if (size_ == capacity_)
+        {
+            if (policy_ == OverflowPolicy::Reject || capacity_ == 0)
+            {
+                stats_.on_reject();
+                return false;
+            }
+            // Full ring: the slot of the oldest element becomes the newest
+            evict_front();
+        }
+        size_t tail = head_ + size_;
+        if (tail >= capacity_)
+        {
+            tail -= capacity_;
+        }
+        new (&buffer_[tail]) T(std::forward<Args>(args)...);
+        if (size_of_)
+        {
+            sizes_[tail] = bytes;
+            bytes_ += bytes;
+            bytes_high_water_ = std::max(bytes_high_water_, bytes_);
+        }
+        ++size_;
+        stats_.on_push(size_);
+        if (was_empty)
+        {
+            signal_ready();
+        }
+        return true;
+    }
+
+    // Called with mutex_ held: the eventfd counter is non-zero exactly while size_ > 0 or stopped_
+    void signal_ready()
+    {
+        if (event_fd_ != -1)
+        {
+            uint64_t one = 1;
+            ssize_t ret = ::write(event_fd_, &one, sizeof(one));
+            (void)ret;
+        }
+    }
+
+    // Called with mutex_ held
+    void clear_ready()
+    {
+        if (event_fd_ != -1 && size_ == 0 && !stopped_)
+        {
+            uint64_t count;
+            ssize_t ret = ::read(event_fd_, &count, sizeof(count));
+            (void)ret;
+        }
+    }
+
+    // Called with mutex_ held, checks the byte budget for an element of the given size
+    bool make_room(size_t bytes)
+    {
+        if (!size_of_ || bytes_ + bytes <= max_bytes_)
+        {
+            return true;
+        }
+        if (policy_ == OverflowPolicy::Reject || bytes > max_bytes_)
+        {
+            return false;
+        }
+        while (bytes_ + bytes > max_bytes_)
+        {
+            evict_front();
+        }
+        return true;
+    }
+
+    // Called with mutex_ held on a non-empty queue
+    void evict_front()
+    {
+        pop_front();
+        ++evictions_;
+        stats_.on_evict();
+    }
+
+    // Called with mutex_ held on a non-empty queue
+    void take_front(T &value)
+    {
+        value = std::move(buffer_[head_]);
+        pop_front();
+        clear_ready();
+        stats_.on_pop(1);
+    }
+
+    void wait_ready(std::unique_lock<std::mutex> &lock)
+    {
+        auto ready = [this]() { return size_ > 0 || stopped_; };
+        if constexpr (Stats::kEnabled)
+        {
+            if (!ready())
+            {
+                auto start = std::chrono::steady_clock::now();
+                cv_.wait(lock, ready);
+                stats_.on_wait(elapsed_ns(start));
+            }
+        }
+        else
+        {
+            cv_.wait(lock, ready);
+        }
+    }
+
+    bool wait_ready_until(std::unique_lock<std::mutex> &lock, const std::chrono::steady_clock::time_point &deadline)
+    {
+        auto ready = [this]() { return size_ > 0 || stopped_; };
+        if constexpr (Stats::kEnabled)
+        {
+            if (!ready())
+            {
+                auto start = std::chrono::steady_clock::now();
+                bool result = cv_.wait_until(lock, deadline, ready);
+                stats_.on_wait(elapsed_ns(start));
+                return result;
+            }
+            return true;
+        }
+        else
+        {
+            return cv_.wait_until(lock, deadline, ready);
+        }
+    }
+
+    static uint64_t elapsed_ns(const std::chrono::steady_clock::time_point &start)
+    {
+        return static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+    }
+
+    // Called with mutex_ held on a non-empty queue
+    void pop_front()
+    {
+        if (size_of_)
+        {
+            bytes_ -= sizes_[head_];
+        }
+        buffer_[head_].~T();
+        head_ = next(head_);
+        --size_;
+    }
+
+    // Called with mutex_ held
+    size_t take(std::vector<T> &out, size_t max)
+    {
+        size_t count = std::min(max, size_);
+        out.reserve(out.size() + count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            out.push_back(std::move(buffer_[head_]));
+            pop_front();
+        }
+        clear_ready();
+        stats_.on_pop(count);
+        return count;
+    }
+
     size_t capacity_;
-    std::queue<T> queue_;
+    OverflowPolicy policy_;
+    T *buffer_;
+    size_t head_ = 0;
+    size_t size_ = 0;
+    size_t evictions_ = 0;
+    size_t max_bytes_ = 0;
+    std::function<size_t(const T &)> size_of_;
+    std::vector<size_t> sizes_;
+    size_t bytes_ = 0;
+    size_t bytes_high_water_ = 0;
+    int event_fd_ = -1;
+    Stats stats_;
     mutable std::mutex mutex_;
     std::condition_variable cv_;
     bool stopped_;
 };
 
-#endif // __SAFE_QUEUE_H__
\ No newline at end of file
+#endif // __SAFE_QUEUE_H__
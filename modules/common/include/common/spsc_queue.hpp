@@ -0,0 +1,260 @@
+#ifndef __SPSC_QUEUE_H__
+#define __SPSC_QUEUE_H__
+
+#include "thread_utils.hpp"
+
+#include <atomic>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <utility>
+
+/**
+ * @brief Lock-free single-producer single-consumer ring buffer with the SafeQueue interface
+ * @tparam T Type of elements stored in the queue
+ * @note Exactly one thread may call push(), and exactly one thread may call pop()/try_pop()/clear().
+ *       The capacity is rounded up to a power of two. pop() spins and yields briefly, then sleeps on a futex,
+ *       the producer only makes a syscall when the consumer is asleep.
+ */
+template <typename T>
+class SpscQueue
+{
+public:
+    explicit SpscQueue(size_t cap = 200)
+        : capacity_(round_up_pow2(cap)),
+          mask_(capacity_ - 1),
+          buffer_(std::allocator<T>().allocate(capacity_))
+    {
+    }
+
+    SpscQueue(const SpscQueue &) = delete;
+    SpscQueue &operator=(const SpscQueue &) = delete;
+
+    ~SpscQueue()
+    {
+        stop();
+        size_t head = consumer_.head.load(std::memory_order_relaxed);
+        size_t tail = producer_.tail.load(std::memory_order_relaxed);
+        for (; head != tail; ++head)
+        {
+            buffer_[head & mask_].~T();
+        }
+        std::allocator<T>().deallocate(buffer_, capacity_);
+    }
+
+    /**
+     * @brief Push element to queue (producer thread only)
+     * @param value Element to push
+     * @return true if push succeeded, false if queue is full
+     */
+    bool push(const T &value)
+    {
+        return emplace(value);
+    }
+
+    bool push(T &&value)
+    {
+        return emplace(std::move(value));
+    }
+
+    /**
+     * @brief Try to pop element from queue (non-blocking, consumer thread only)
+     * @param value Output parameter for popped element
+     * @return true if pop succeeded, false if queue is empty
+     */
+    bool try_pop(T &value)
+    {
+        size_t head = consumer_.head.load(std::memory_order_relaxed);
+        if (head == consumer_.cached_tail)
+        {
+            consumer_.cached_tail = producer_.tail.load(std::memory_order_acquire);
+            if (head == consumer_.cached_tail)
+            {
+                return false;
+            }
+        }
+        T &slot = buffer_[head & mask_];
+        value = std::move(slot);
+        slot.~T();
+        consumer_.head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Pop element from queue (blocking, consumer thread only)
+     * @param value Output parameter for popped element
+     * @return true if pop succeeded, false if stopped
+     * @note Blocks until data is available or stop() is called
+     */
+    bool pop(T &value)
+    {
+        // Spinning only helps when the producer runs on another cpu
+        static const int spin = std::thread::hardware_concurrency() > 1 ? kSpin : 0;
+        for (int i = 0; i < spin; ++i)
+        {
+            if (stopped_.load(std::memory_order_acquire))
+            {
+                return false;
+            }
+            if (try_pop(value))
+            {
+                return true;
+            }
+            cpu_relax();
+        }
+        // Give the producer a chance to run before paying for a futex sleep and wake
+        for (int i = 0; i < kYield; ++i)
+        {
+            if (stopped_.load(std::memory_order_acquire))
+            {
+                return false;
+            }
+            if (try_pop(value))
+            {
+                return true;
+            }
+            std::this_thread::yield();
+        }
+        for (;;)
+        {
+            if (stopped_.load(std::memory_order_acquire))
+            {
+                return false;
+            }
+            uint32_t seq = wake_seq_.load(std::memory_order_acquire);
+            consumer_waiting_.store(true, std::memory_order_relaxed);
+            // Pairs with the fence in emplace(): either we see the element or the producer sees us waiting
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (try_pop(value))
+            {
+                consumer_waiting_.store(false, std::memory_order_relaxed);
+                return true;
+            }
+            if (!stopped_.load(std::memory_order_acquire))
+            {
+                futex_wait(wake_seq_, seq);
+            }
+            consumer_waiting_.store(false, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @brief Stop queue operations, wakes a consumer blocked in pop()
+     */
+    void stop()
+    {
+        if (stopped_.exchange(true, std::memory_order_acq_rel))
+        {
+            return;
+        }
+        wake_seq_.fetch_add(1, std::memory_order_release);
+        futex_wake(wake_seq_, INT_MAX);
+    }
+
+    /**
+     * @brief Clear all elements in queue (consumer thread only)
+     */
+    void clear()
+    {
+        size_t head = consumer_.head.load(std::memory_order_relaxed);
+        size_t tail = producer_.tail.load(std::memory_order_acquire);
+        for (; head != tail; ++head)
+        {
+            buffer_[head & mask_].~T();
+        }
+        consumer_.cached_tail = tail;
+        consumer_.head.store(tail, std::memory_order_release);
+    }
+
+    /**
+     * @brief Get current queue size
+     * @return Number of elements in queue, a snapshot when called concurrently
+     */
+    size_t size() const
+    {
+        size_t head = consumer_.head.load(std::memory_order_acquire);
+        size_t tail = producer_.tail.load(std::memory_order_acquire);
+        return tail - head;
+    }
+
+    /**
+     * @brief Check if queue is empty
+     * @return true if empty, false otherwise
+     */
+    bool empty() const
+    {
+        return size() == 0;
+    }
+
+    /**
+     * @brief Get the capacity after rounding up to a power of two
+     */
+    size_t capacity() const
+    {
+        return capacity_;
+    }
+
+private:
+    static constexpr int kSpin = 256;
+    static constexpr int kYield = 8;
+
+    static size_t round_up_pow2(size_t value)
+    {
+        size_t result = 1;
+        while (result < value)
+        {
+            result <<= 1;
+        }
+        return result;
+    }
+
+    template <typename U>
+    bool emplace(U &&value)
+    {
+        size_t tail = producer_.tail.load(std::memory_order_relaxed);
+        if (tail - producer_.cached_head == capacity_)
+        {
+            producer_.cached_head = consumer_.head.load(std::memory_order_acquire);
+            if (tail - producer_.cached_head == capacity_)
+            {
+                return false;
+            }
+        }
+        new (&buffer_[tail & mask_]) T(std::forward<U>(value));
+        producer_.tail.store(tail + 1, std::memory_order_release);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (consumer_waiting_.load(std::memory_order_relaxed))
+        {
+            wake_seq_.fetch_add(1, std::memory_order_release);
+            futex_wake(wake_seq_, 1);
+        }
+        return true;
+    }
+
+    // Written by the consumer, the producer only reads head
+    struct alignas(64) ConsumerSide
+    {
+        std::atomic<size_t> head{0};
+        size_t cached_tail = 0;
+    };
+
+    // Written by the producer, the consumer only reads tail
+    struct alignas(64) ProducerSide
+    {
+        std::atomic<size_t> tail{0};
+        size_t cached_head = 0;
+    };
+
+    const size_t capacity_;
+    const size_t mask_;
+    T *buffer_;
+    ConsumerSide consumer_;
+    ProducerSide producer_;
+    alignas(64) std::atomic<uint32_t> wake_seq_{0};
+    std::atomic<bool> consumer_waiting_{false};
+    std::atomic<bool> stopped_{false};
+};
+
+#endif // __SPSC_QUEUE_H__
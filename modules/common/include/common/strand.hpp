@@ -0,0 +1,178 @@
+#ifndef __STRAND_H__
+#define __STRAND_H__
+
+#include "future.hpp"
+
+#include <deque>
+#include <exception>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+/**
+ * @brief Serial executor on top of another executor (usually a ThreadPool)
+ *
+ * Tasks posted to one strand run one at a time, in FIFO order, on any worker of the
+ * underlying executor. Different strands run in parallel. A strand owns no thread and
+ * its lock is never shared with other strands.
+ *
+ *   ThreadPool pool(4);
+ *   Strand lidar(pool), camera(pool);
+ *   lidar.post([&]() { handle(scan); });     // ordered with other lidar tasks
+ *   camera.post([&]() { handle(image); });   // may run concurrently with lidar tasks
+ */
+class Strand : public Executor {
+public:
+    /**
+     * @brief Construct a strand
+     * @param executor Executor that runs the strand's tasks, must outlive all posted work
+     */
+    explicit Strand(Executor& executor) : impl_(std::make_shared<Impl>(executor)) {}
+
+    Strand(const Strand&) = delete;
+    Strand& operator=(const Strand&) = delete;
+
+    /**
+     * @brief Schedule a task after all tasks previously posted to this strand
+     * @param task Task to run, exceptions are reported on stderr and do not stop the strand
+     * @throws std::runtime_error if the underlying executor refuses the task (e.g. stopped pool),
+     *         the task is not queued then, nor are tasks other threads posted meanwhile
+     * @note Tasks already posted keep running even if the Strand object is destroyed
+     */
+    void post(std::function<void()> task) override {
+        impl_->post(std::move(task));
+    }
+
+    /**
+     * @brief Run f on the strand and get a Future whose continuations also run on the strand
+     * @param f Function to execute
+     * @param args Arguments to pass to the function
+     * @note The future keeps the strand's queue alive, then() stays valid after the Strand is destroyed
+     */
+    template<typename F, typename... Args>
+    auto async(F&& f, Args&&... args) -> Future<decltype(f(args...))> {
+        using return_type = decltype(f(args...));
+
+        auto promise = std::make_shared<Promise<return_type>>(std::shared_ptr<Executor>(impl_));
+        auto future = promise->get_future();
+        auto bound = std::bind(std::forward<F>(f), std::forward<Args>(args)...);
+        auto task = std::make_shared<decltype(bound)>(std::move(bound));
+        post([promise, task]() { detail::fulfil(*promise, *task); });
+        return future;
+    }
+
+    /**
+     * @brief Check if the calling thread is currently running a task of this strand
+     */
+    bool running_in_this_thread() const {
+        return current_ == impl_.get();
+    }
+
+    /**
+     * @brief Get number of tasks waiting in this strand
+     */
+    size_t pending_tasks() const {
+        std::lock_guard<std::mutex> lock(impl_->mtx);
+        return impl_->queue.size();
+    }
+
+private:
+    // The queue, shared by the Strand, its queued drain and the futures of async()
+    struct Impl : Executor, std::enable_shared_from_this<Impl> {
+        // Tasks run per hand-off before yielding the worker to other work
+        static constexpr size_t kBatch = 64;
+
+        explicit Impl(Executor& e) : executor(e) {}
+
+        void post(std::function<void()> task) override {
+            bool first = false;
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                queue.push_back(std::move(task));
+                if(!scheduled) {
+                    scheduled = true;
+                    first = true;
+                }
+            }
+            if(first) {
+                schedule();
+            }
+        }
+
+        void schedule() {
+            auto self = shared_from_this();
+            try {
+                executor.post([self]() { self->drain(); });
+            } catch (...) {
+                // No drain will run: drop what was queued since (the queue was empty before), so that
+                // scheduled stays false only with an empty queue. Destroy it unlocked, a task may post here.
+                std::exception_ptr error = std::current_exception();
+                std::deque<std::function<void()>> refused;
+                {
+                    std::lock_guard<std::mutex> lock(mtx);
+                    refused.swap(queue);
+                    scheduled = false;
+                }
+                refused.clear();
+                std::rethrow_exception(error);
+            }
+        }
+
+        void drain() {
+            for(;;) {
+                if(!run_batch()) {
+                    return;
+                }
+                // Still busy: hand the rest back to the executor so one strand cannot starve the pool
+                try {
+                    auto self = shared_from_this();
+                    executor.post([self]() { self->drain(); });
+                    return;
+                } catch (const std::exception&) {
+                    // Refused (e.g. the pool is stopping): keep draining here so no task is lost
+                }
+            }
+        }
+
+        // Run up to kBatch tasks, returns false once the queue is empty
+        bool run_batch() {
+            const Impl* outer = current_;
+            current_ = this;
+            for(size_t i = 0; i < kBatch; ++i) {
+                std::function<void()> task;
+                {
+                    std::lock_guard<std::mutex> lock(mtx);
+                    if(queue.empty()) {
+                        scheduled = false;
+                        current_ = outer;
+                        return false;
+                    }
+                    task = std::move(queue.front());
+                    queue.pop_front();
+                }
+                try {
+                    task();
+                } catch (const std::exception& e) {
+                    std::cerr << "[STRAND] task threw: " << e.what() << std::endl;
+                } catch (...) {
+                    std::cerr << "[STRAND] task threw an unknown exception" << std::endl;
+                }
+            }
+            current_ = outer;
+            return true;
+        }
+
+        Executor& executor;
+        mutable std::mutex mtx;
+        std::deque<std::function<void()>> queue;
+        bool scheduled = false;  // A drain is queued or running, guarded by mtx
+    };
+
+    static inline thread_local const Impl* current_ = nullptr;
+
+    std::shared_ptr<Impl> impl_;
+};
+
+#endif // __STRAND_H__
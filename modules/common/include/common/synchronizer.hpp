@@ -0,0 +1,289 @@
+#ifndef __SYNCHRONIZER_H__
+#define __SYNCHRONIZER_H__
+
+#include "safe_queue.hpp"
+#include "wait_set.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <map>
+#include <mutex>
+#include <tuple>
+#include <utility>
+
+/**
+ * @brief How Synchronizer decides that samples of different inputs belong together
+ */
+enum class SyncPolicy
+{
+    ExactTime,       // Every input has a sample with the same timestamp
+    ApproximateTime, // Every input has a sample within tolerance of a pivot timestamp
+};
+
+struct SyncOptions
+{
+    SyncPolicy policy = SyncPolicy::ApproximateTime;
+    std::chrono::nanoseconds tolerance = std::chrono::milliseconds(10); // ApproximateTime only
+    size_t buffer_size = 32;                                              // Samples kept per input, the oldest is dropped beyond it
+};
+
+/**
+ * @brief Matches timestamped samples of N inputs (camera, lidar, IMU, ...) into tuples
+ * @tparam Ts Sample type of each input, in input order
+ *
+ * Each input buffers up to buffer_size samples in a map ordered by timestamp, so an arrival costs
+ * O(log n) per input. A match emits the chosen sample of every input and drops everything older.
+ *
+ * ApproximateTime assumes each input delivers in timestamp order. The pivot is the oldest buffered
+ * sample of the input whose oldest sample is newest; every tuple contains a sample at or after it,
+ * so older samples further than tolerance away are dropped. From each input the sample nearest the
+ * pivot is taken once that input has delivered a sample at or after the pivot. If one of them is
+ * further than tolerance away, the pivot sample is dropped instead.
+ *
+ *   SyncOptions options;
+ *   options.tolerance = std::chrono::milliseconds(5);
+ *   Synchronizer<Image, Cloud> sync(options, [](const Image& i) { return i.stamp_ns; },
+ *                                   [](const Cloud& c) { return c.stamp_ns; });
+ *   sync.on_match([](std::tuple<Image, Cloud>&& pair) { fuse(std::get<0>(pair), std::get<1>(pair)); });
+ *   sync.run(image_queue, cloud_queue);  // or sync.add<0>(image) from the producers
+ */
+template <typename... Ts>
+class Synchronizer
+{
+public:
+    using Tuple = std::tuple<Ts...>;
+    using Callback = std::function<void(Tuple &&)>;
+
+    /**
+     * @param options Matching policy and buffer bound
+     * @param stamp One function per input returning the sample timestamp in nanoseconds
+     */
+    explicit Synchronizer(const SyncOptions &options, std::function<int64_t(const Ts &)>... stamp)
+        : options_(options),
+          stamps_(std::move(stamp)...)
+    {
+        options_.buffer_size = std::max<size_t>(options_.buffer_size, 1);
+    }
+
+    Synchronizer(const Synchronizer &) = delete;
+    Synchronizer &operator=(const Synchronizer &) = delete;
+
+    /**
+     * @brief Set the function receiving matched tuples
+     * @note Runs on the thread calling add() with the synchronizer locked, must not call add() itself
+     */
+    void on_match(Callback callback)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        callback_ = std::move(callback);
+    }
+
+    /**
+     * @brief Push matched tuples to a queue instead, tuples the queue rejects are lost
+     */
+    template <typename Stats>
+    void output_to(SafeQueue<Tuple, Stats> &queue)
+    {
+        on_match([&queue](Tuple &&tuple) { queue.push(std::move(tuple)); });
+    }
+
+    /**
+     * @brief Feed a sample of input I, emits every tuple it completes
+     * @param value Sample, copied or moved into the input buffer
+     */
+    template <size_t I, typename U>
+    void add(U &&value)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto &buffer = std::get<I>(buffers_);
+        int64_t stamp = std::get<I>(stamps_)(value);
+        buffer.emplace(stamp, std::forward<U>(value));
+        if (buffer.size() > options_.buffer_size)
+        {
+            buffer.erase(buffer.begin());
+            ++dropped_;
+        }
+
+        if (options_.policy == SyncPolicy::ExactTime)
+        {
+            match_exact(stamp, std::index_sequence_for<Ts...>{});
+        }
+        else
+        {
+            while (match_approximate(std::index_sequence_for<Ts...>{}))
+            {
+            }
+        }
+    }
+
+    /**
+     * @brief Consume the input queues on the calling thread until one of them is stopped
+     * @param queues One SafeQueue per input, in input order
+     */
+    template <typename... Queues>
+    void run(Queues &...queues)
+    {
+        static_assert(sizeof...(Queues) == sizeof...(Ts), "one queue per input");
+        WaitSet set;
+        (set.add(queues), ...);
+        while (!(queues.stopped() || ...))
+        {
+            set.wait_any();
+            drain(std::index_sequence_for<Ts...>{}, queues...);
+        }
+    }
+
+    /**
+     * @brief Get the number of tuples emitted
+     */
+    uint64_t matched() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return matched_;
+    }
+
+    /**
+     * @brief Get the number of samples dropped unmatched, by the buffer bound or as too old
+     */
+    uint64_t dropped() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return dropped_;
+    }
+
+private:
+    template <size_t... Is, typename... Queues>
+    void drain(std::index_sequence<Is...>, Queues &...queues)
+    {
+        (drain_one<Is>(queues), ...);
+    }
+
+    template <size_t I, typename Queue>
+    void drain_one(Queue &queue)
+    {
+        std::tuple_element_t<I, Tuple> value;
+        while (queue.try_pop(value))
+        {
+            add<I>(std::move(value));
+        }
+    }
+
+    // Called with mutex_ held
+    template <size_t... Is>
+    void match_exact(int64_t stamp, std::index_sequence<Is...>)
+    {
+        auto chosen = std::make_tuple(std::get<Is>(buffers_).find(stamp)...);
+        if (((std::get<Is>(chosen) != std::get<Is>(buffers_).end()) && ...))
+        {
+            emit(chosen, std::index_sequence<Is...>{});
+        }
+    }
+
+    // Called with mutex_ held, returns true if it emitted or dropped a sample and should run again
+    template <size_t... Is>
+    bool match_approximate(std::index_sequence<Is...>)
+    {
+        if (!(!std::get<Is>(buffers_).empty() && ...))
+        {
+            return false;
+        }
+        int64_t pivot = std::max({std::get<Is>(buffers_).begin()->first...});
+        int64_t tolerance = options_.tolerance.count();
+
+        // Prune: samples older than pivot - tolerance can never be within tolerance of it
+        bool complete = (prune(std::get<Is>(buffers_), pivot - tolerance) && ...);
+        if (!complete)
+        {
+            return false;
+        }
+
+        // Wait until every input has a sample at or after the pivot, later ones are only further away
+        auto after = std::make_tuple(std::get<Is>(buffers_).lower_bound(pivot)...);
+        if (!((std::get<Is>(after) != std::get<Is>(buffers_).end()) && ...))
+        {
+            return false;
+        }
+
+        auto chosen = std::make_tuple(nearest(std::get<Is>(buffers_), std::get<Is>(after), pivot)...);
+        if (((gap(std::get<Is>(chosen)->first, pivot) <= tolerance) && ...))
+        {
+            emit(chosen, std::index_sequence<Is...>{});
+            return true;
+        }
+
+        // Some input has no sample near the pivot and never will, so the pivot sample cannot be matched
+        drop_pivot(pivot, std::index_sequence<Is...>{});
+        return true;
+    }
+
+    template <typename Buffer>
+    bool prune(Buffer &buffer, int64_t oldest)
+    {
+        while (!buffer.empty() && buffer.begin()->first < oldest)
+        {
+            buffer.erase(buffer.begin());
+            ++dropped_;
+        }
+        return !buffer.empty();
+    }
+
+    template <typename Buffer>
+    static typename Buffer::iterator nearest(Buffer &buffer, typename Buffer::iterator after, int64_t pivot)
+    {
+        if (after == buffer.begin())
+        {
+            return after;
+        }
+        auto before = std::prev(after);
+        return gap(before->first, pivot) < gap(after->first, pivot) ? before : after;
+    }
+
+    static int64_t gap(int64_t a, int64_t b)
+    {
+        return a > b ? a - b : b - a;
+    }
+
+    template <size_t... Is>
+    void drop_pivot(int64_t pivot, std::index_sequence<Is...>)
+    {
+        // Only the first input holding the pivot as its oldest sample gives it up
+        bool dropped = false;
+        auto drop = [&](auto &buffer) {
+            if (!dropped && buffer.begin()->first == pivot)
+            {
+                buffer.erase(buffer.begin());
+                ++dropped_;
+                dropped = true;
+            }
+        };
+        (drop(std::get<Is>(buffers_)), ...);
+    }
+
+    // Called with mutex_ held: moves the chosen samples out, then drops them and everything older
+    template <typename Chosen, size_t... Is>
+    void emit(Chosen &chosen, std::index_sequence<Is...>)
+    {
+        Tuple tuple(std::move(std::get<Is>(chosen)->second)...);
+        dropped_ += (static_cast<uint64_t>(std::distance(std::get<Is>(buffers_).begin(), std::get<Is>(chosen))) + ...);
+        (std::get<Is>(buffers_).erase(std::get<Is>(buffers_).begin(), std::next(std::get<Is>(chosen))), ...);
+        ++matched_;
+        if (callback_)
+        {
+            callback_(std::move(tuple));
+        }
+    }
+
+    SyncOptions options_;
+    std::tuple<std::function<int64_t(const Ts &)>...> stamps_;
+    std::tuple<std::multimap<int64_t, Ts>...> buffers_;
+    Callback callback_;
+    uint64_t matched_ = 0;
+    uint64_t dropped_ = 0;
+    mutable std::mutex mutex_;
+};
+
+#endif // __SYNCHRONIZER_H__
@@ -0,0 +1,191 @@
+#ifndef __TASK_GROUP_H__
+#define __TASK_GROUP_H__
+
+#include "thread_pool.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Thrown by TaskGroup::wait(), holds every exception thrown by the group's tasks
+ */
+class TaskGroupError : public std::runtime_error {
+public:
+    explicit TaskGroupError(std::vector<std::exception_ptr> errors)
+        : std::runtime_error(describe(errors)), errors_(std::move(errors)) {}
+
+    /**
+     * @brief Exceptions in the order the tasks failed
+     */
+    const std::vector<std::exception_ptr>& errors() const {
+        return errors_;
+    }
+
+private:
+    static std::string describe(const std::vector<std::exception_ptr>& errors) {
+        std::string first = "unknown exception";
+        try {
+            if(!errors.empty()) {
+                std::rethrow_exception(errors.front());
+            }
+        } catch (const std::exception& e) {
+            first = e.what();
+        } catch (...) {
+        }
+        return std::to_string(errors.size()) + " task(s) failed, first: " + first;
+    }
+
+    std::vector<std::exception_ptr> errors_;
+};
+
+/**
+ * @brief Scoped fork-join on a ThreadPool
+ *
+ * The first failing task cancels its siblings: the ones not started yet are dropped, running
+ * ones see ThreadPool::current_token() turn true. wait() rethrows every failure at once.
+ * No task outlives the group, the destructor waits (and cancels first while unwinding).
+ *
+ *   TaskGroup group(pool);
+ *   for (auto& tile : tiles) {
+ *       group.spawn([&tile]() { process(tile); });
+ *   }
+ *   group.wait();  // throws TaskGroupError if any process() threw
+ */
+class TaskGroup {
+public:
+    explicit TaskGroup(ThreadPool& pool) : pool_(pool), state_(std::make_shared<State>()) {}
+
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    ~TaskGroup() {
+        if(std::uncaught_exceptions() > uncaught_) {
+            cancel();
+        }
+        join();
+    }
+
+    /**
+     * @brief Run f on the pool as a child of this group
+     * @param f Callable without arguments, may poll ThreadPool::current_token() to stop early
+     * @throws std::runtime_error if the pool is stopped
+     * @note Never waits for queue space, so children may spawn into their own group
+     */
+    template<typename F>
+    void spawn(F&& f) {
+        {
+            std::lock_guard<std::mutex> lock(state_->mtx);
+            ++state_->pending;
+        }
+        // The guard completes the child when the pool destroys the task, whether it ran or was dropped
+        auto guard = std::make_shared<ChildGuard>(state_);
+        auto fn = std::make_shared<std::decay_t<F>>(std::forward<F>(f));  // Move-only callables fit too
+        TaskOptions options;
+        options.token = state_->source.token();
+        pool_.post_with(options, [guard, fn]() {
+            try {
+                (*fn)();
+            } catch (...) {
+                guard->state->fail(std::current_exception());
+            }
+        });
+    }
+
+    /**
+     * @brief Wait for every child, help the pool when called from one of its workers
+     * @throws TaskGroupError if any child threw, the errors are cleared so the group can be reused
+     */
+    void wait() {
+        join();
+        std::vector<std::exception_ptr> errors;
+        {
+            std::lock_guard<std::mutex> lock(state_->mtx);
+            errors.swap(state_->errors);
+        }
+        if(!errors.empty()) {
+            throw TaskGroupError(std::move(errors));
+        }
+    }
+
+    /**
+     * @brief Cancel the children that have not finished
+     */
+    void cancel() {
+        state_->source.cancel();
+    }
+
+    bool is_cancelled() const {
+        return state_->source.is_cancelled();
+    }
+
+    /**
+     * @brief Token shared by the children, e.g. to pass into work outside the pool
+     */
+    CancellationToken token() const {
+        return state_->source.token();
+    }
+
+private:
+    struct State {
+        std::mutex mtx;
+        std::condition_variable cv;
+        size_t pending = 0;
+        std::vector<std::exception_ptr> errors;
+        CancellationSource source;
+
+        void fail(std::exception_ptr error) {
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                errors.push_back(std::move(error));
+            }
+            source.cancel();
+        }
+
+        void complete() {
+            std::lock_guard<std::mutex> lock(mtx);
+            if(--pending == 0) {
+                cv.notify_all();
+            }
+        }
+    };
+
+    struct ChildGuard {
+        explicit ChildGuard(std::shared_ptr<State> s) : state(std::move(s)) {}
+        ~ChildGuard() {
+            state->complete();
+        }
+        std::shared_ptr<State> state;
+    };
+
+    void join() {
+        std::unique_lock<std::mutex> ul(state_->mtx);
+        auto done = [this]() { return state_->pending == 0; };
+        if(ThreadPool::current() != &pool_) {
+            state_->cv.wait(ul, done);
+            return;
+        }
+        // On a worker of the same pool: run queued tasks instead of blocking the worker
+        while(!done()) {
+            ul.unlock();
+            bool ran = pool_.run_pending_task();
+            ul.lock();
+            if(!ran) {
+                state_->cv.wait_for(ul, std::chrono::microseconds(100), done);
+            }
+        }
+    }
+
+    ThreadPool& pool_;
+    std::shared_ptr<State> state_;
+    int uncaught_ = std::uncaught_exceptions();
+};
+
+#endif // __TASK_GROUP_H__
@@ -6,49 +6,218 @@
 #include <condition_variable>
 #include <mutex>
 #include <vector>
-#include <queue>
+#include <deque>
+#include <iterator>
+#include <iostream>
+#include <algorithm>
 #include <future>
 #include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "cancellation.hpp"
+#include "future.hpp"
+#include "thread_pool_metrics.hpp"
+#include "thread_utils.hpp"
+#include "worker_context.hpp"
+
+/**
+ * @brief How idle ThreadPool workers wait for tasks
+ */
+enum class WaitStrategy : uint8_t {
+    Block,         // Park on the condition variable right away
+    SpinThenPark,  // Busy-spin with cpu_relax(), then yield, then park; spin budget adapts to arrival rate
+};
+
+/**
+ * @brief What submit does when a bounded queue (max_queue_size > 0) is full
+ */
+enum class AdmissionPolicy : uint8_t {
+    Block,       // Wait for space (try_submit returns QueueFull, submit_for returns Timeout)
+    Reject,      // Refuse the new task
+    DropOldest,  // Evict the oldest task queued by a submit (its future reports broken_promise) and queue the
+                 // new one; post() work is never evicted, the new task is rejected if nothing else can go.
+                 // Under EDF the task with the latest deadline is evicted instead; if that is the new one,
+                 // it is refused (QueueFull)
+    CallerRuns,  // Run the new task on the submitting thread
+};
+
+/**
+ * @brief Order in which workers take queued tasks
+ */
+enum class SchedulingPolicy : uint8_t {
+    Fifo,                   // Submission order
+    EarliestDeadlineFirst,  // Earliest TaskOptions::deadline first, FIFO among equal deadlines; a task without
+                            // one counts as due ThreadPoolOptions::no_deadline_slack after it was queued
+};
+
+/**
+ * @brief Outcome of ThreadPool::try_submit/submit_for
+ */
+enum class SubmitStatus : uint8_t {
+    Ok,         // Queued, or run by the caller under AdmissionPolicy::CallerRuns
+    QueueFull,  // Refused without waiting
+    Timeout,    // No space before the timeout
+    Stopped,    // Pool is shutting down
+};
+
+/**
+ * @brief Status and future of a non-throwing submit
+ */
+template<typename R>
+struct SubmitResult {
+    SubmitStatus status;
+    std::future<R> future;  // Valid only if status == SubmitStatus::Ok
+
+    explicit operator bool() const {
+        return status == SubmitStatus::Ok;
+    }
+};
+
+/**
+ * @brief Construction options of ThreadPool
+ */
+struct ThreadPoolOptions {
+    size_t thread_num = 1;                  // Number of worker threads
+    size_t max_queue_size = 0;              // Maximum task queue size (0 = unlimited)
+    AdmissionPolicy admission_policy = AdmissionPolicy::Block;  // Behaviour when the queue is full
+    SchedulingPolicy scheduling = SchedulingPolicy::Fifo;       // Order in which queued tasks run
+    std::chrono::milliseconds no_deadline_slack{100};  // EDF: tasks without a deadline (post(), continuations,
+                                                      // strands, submit_bulk) age into the order instead of starving
+    std::string name;                       // Worker names become "<name>-<index>", empty keeps the inherited name
+    std::vector<std::vector<int>> cpu_sets; // Worker i is pinned to cpu_sets[i % size], empty = no pinning
+    int sched_policy = SCHED_OTHER;         // SCHED_OTHER, SCHED_BATCH, SCHED_IDLE, SCHED_FIFO or SCHED_RR
+    int sched_priority = 0;                 // Static priority for SCHED_FIFO/SCHED_RR
+
+    // Elastic mode, enabled when max_threads > min_threads; a supervisor thread times the growth
+    size_t min_threads = 0;                 // Lower bound of live workers (0 = thread_num)
+    size_t max_threads = 0;                 // Upper bound of live workers (0 = thread_num)
+    std::chrono::microseconds spawn_wait_threshold{1000};  // Spawn when the oldest task waited this long
+    std::chrono::milliseconds idle_timeout{10000};         // Retire a worker idle for this long
+    std::chrono::milliseconds resize_cooldown{100};        // Minimum time between two resizes (hysteresis)
+
+    // Idle wait
+    WaitStrategy wait_strategy = WaitStrategy::Block;
+    std::chrono::microseconds max_spin{50};   // Upper bound of the adaptive spin phase
+    std::chrono::microseconds yield_time{20}; // sched_yield phase between spinning and parking
+
+    // Worker-local context, see ThreadPool::worker_context()
+    size_t scratch_arena_size = 64 * 1024;    // First block of each worker's scratch arena, allocated on first use
+    std::function<void(WorkerContext&)> worker_init;  // Runs on every worker thread before it takes tasks
+
+    // Extra workers spawned while workers sit in ThreadPool::blocking() scopes (0 = only measure)
+    size_t max_blocking_compensation = 4;
+};
+
+/**
+ * @brief Per-task options for ThreadPool::submit_with/async_with
+ */
+struct TaskOptions {
+    CancellationToken token;  // Task is dropped before start once cancelled
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max();  // Dropped if not started by then
+    bool drop_if_late = true;  // false: still run after the deadline, counted as a deadline miss
+};
+
+namespace detail {
+
+// Shared by the tasks of one ThreadPool::submit_bulk call. If tasks are dropped without running
+// (eviction, shutdown), the last reference destroys the promise, which reports broken_promise.
+template<typename Item, typename F>
+struct BulkState {
+    BulkState(std::vector<Item>&& items_, F&& fn_, Executor* executor)
+        : items(std::move(items_)), fn(std::move(fn_)), remaining(items.size()), promise(executor) {}
+
+    void run(size_t index) {
+        std::exception_ptr failure;
+        try {
+            fn(items[index]);
+        } catch (...) {
+            failure = std::current_exception();
+        }
+        complete_one(failure);
+    }
+
+    void complete_one(std::exception_ptr failure) {
+        if(failure) {
+            std::lock_guard<std::mutex> lock(mtx);
+            if(!error) {
+                error = failure;
+            }
+        }
+        if(remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            if(error) {
+                promise.set_exception(error);
+            } else {
+                promise.set_value();
+            }
+        }
+    }
+
+    std::vector<Item> items;
+    F fn;
+    std::atomic<size_t> remaining;
+    std::mutex mtx;
+    std::exception_ptr error;  // First failure
+    Promise<void> promise;
+};
+
+}  // namespace detail
 
 /**
  * @brief Thread-safe thread pool with configurable capacity
  */
-class ThreadPool
+class ThreadPool : public Executor
 {
 public:
+    using Clock = std::chrono::steady_clock;
+
     /**
      * @brief Construct thread pool with specified number of threads
      * @param thread_num Number of worker threads
      * @param max_queue_size Maximum task queue size (0 = unlimited)
      */
     explicit ThreadPool(size_t thread_num, size_t max_queue_size = 0)
-        : stop_(false), max_queue_size_(max_queue_size) {
-        for(size_t i = 0; i < thread_num; ++i) {
-            workers_.emplace_back([this]() {
-                for(;;) {
-                    std::function<void()> task;
-                    {
-                        std::unique_lock<std::mutex> ul(mtx_);
-                        cv_.wait(ul, [this]() { return stop_.load() || !tasks_.empty(); });
-                        if(stop_.load() && tasks_.empty()) {
-                            return;
-                        }
-                        task = std::move(tasks_.front());
-                        tasks_.pop();
-                    }
-                    cv_producer_.notify_one();  // Notify if queue was full
-                    task();
-                }
-            });
+        : ThreadPool(make_options(thread_num, max_queue_size)) {}
+
+    /**
+     * @brief Construct thread pool from options
+     * @param options Worker count, queue size, thread names, cpu affinity and scheduling
+     * @note Affinity/scheduling failures are reported on stderr and the worker keeps running
+     */
+    explicit ThreadPool(const ThreadPoolOptions& options)
+        : stop_(false), max_queue_size_(options.max_queue_size), options_(options) {
+        min_threads_ = options_.min_threads > 0 ? options_.min_threads : options_.thread_num;
+        max_threads_ = std::max(min_threads_, options_.max_threads > 0 ? options_.max_threads : options_.thread_num);
+        size_t initial = std::min(std::max(options_.thread_num, min_threads_), max_threads_);
+        // Slots are allocated up front and never move, so metrics() can walk them without the lock
+        workers_.resize(max_threads_ + options_.max_blocking_compensation);
+        std::lock_guard<std::mutex> lock(mtx_);
+        for(size_t i = 0; i < initial; ++i) {
+            spawn_worker();
+        }
+        if(is_elastic()) {
+            supervisor_ = std::thread([this]() { supervise(); });
         }
     }
 
     ~ThreadPool() {
-        stop_.store(true);
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            stop_.store(true);
+        }
         cv_.notify_all();
+        cv_producer_.notify_all();
+        cv_supervisor_.notify_all();
+        if(supervisor_.joinable()) {
+            supervisor_.join();
+        }
+        // Workers are only spawned under the lock, which no longer happens once stop_ is set
         for(auto& worker : workers_) {
-            if (worker.joinable()) {
-                worker.join();
+            if (worker && worker->thread.joinable()) {
+                worker->thread.join();
             }
         }
     }
@@ -60,38 +229,314 @@ public:
      * @param f Function to execute
      * @param args Arguments to pass to the function
      * @return Future containing the result
-     * @throws std::runtime_error if pool is stopped or queue is full
+     * @throws std::runtime_error if pool is stopped, or queue is full under AdmissionPolicy::Reject
+     * @note Blocks while the queue is full under AdmissionPolicy::Block
      */
     template<typename F, typename... Args>
     auto submit(F&& f, Args&&... args) -> std::future<decltype(f(args...))> {
+        return submit_with(TaskOptions(), std::forward<F>(f), std::forward<Args>(args)...);
+    }
+
+    /**
+     * @brief Submit a task that may be cancelled or expire before it starts
+     * @param options Cancellation token and deadline
+     * @param f Function to execute
+     * @param args Arguments to pass to the function
+     * @return Future containing the result, get() throws std::future_error (broken_promise) if the task was dropped
+     * @throws std::runtime_error if pool is stopped, or queue is full under AdmissionPolicy::Reject
+     */
+    template<typename F, typename... Args>
+    auto submit_with(const TaskOptions& options, F&& f, Args&&... args) -> std::future<decltype(f(args...))> {
+        auto result = submit_until(options, Clock::time_point::max(), std::forward<F>(f), std::forward<Args>(args)...);
+        throw_if_refused(result.status);
+        return std::move(result.future);
+    }
+
+    /**
+     * @brief Submit without ever waiting for queue space
+     * @param f Function to execute
+     * @param args Arguments to pass to the function
+     * @return Ok with the future, or QueueFull/Stopped; never throws for a full or stopped pool
+     * @note The admission policy still applies: DropOldest evicts and CallerRuns runs inline
+     */
+    template<typename F, typename... Args>
+    auto try_submit(F&& f, Args&&... args) -> SubmitResult<decltype(f(args...))> {
+        return submit_until(TaskOptions(), Clock::time_point::min(), std::forward<F>(f), std::forward<Args>(args)...);
+    }
+
+    /**
+     * @brief Submit, waiting at most timeout for queue space (AdmissionPolicy::Block)
+     * @param timeout Maximum time to wait
+     * @param f Function to execute
+     * @param args Arguments to pass to the function
+     * @return Ok with the future, or Timeout/QueueFull/Stopped
+     */
+    template<typename Rep, typename Period, typename F, typename... Args>
+    auto submit_for(const std::chrono::duration<Rep, Period>& timeout, F&& f, Args&&... args)
+        -> SubmitResult<decltype(f(args...))> {
+        return submit_until(TaskOptions(), Clock::now() + std::chrono::duration_cast<Clock::duration>(timeout),
+                            std::forward<F>(f), std::forward<Args>(args)...);
+    }
+
+    /**
+     * @brief Submit with task options, waiting until wait_deadline for queue space
+     * @param options Cancellation token and deadline of the task
+     * @param wait_deadline Clock::time_point::max() waits forever, min() never waits
+     */
+    template<typename F, typename... Args>
+    auto submit_until(const TaskOptions& options, Clock::time_point wait_deadline, F&& f, Args&&... args)
+        -> SubmitResult<decltype(f(args...))> {
         using return_type = decltype(f(args...));
 
         auto taskPtr = std::make_shared<std::packaged_task<return_type()>>(
             std::bind(std::forward<F>(f), std::forward<Args>(args)...)
         );
+        auto future = taskPtr->get_future();
+        std::function<void()> task([taskPtr]() { (*taskPtr)(); });
+        SubmitStatus status = admit(task, options, wait_deadline);
+        if(status != SubmitStatus::Ok) {
+            return SubmitResult<return_type>{status, std::future<return_type>()};
+        }
+        return SubmitResult<return_type>{status, std::move(future)};
+    }
 
-        {
-            std::unique_lock<std::mutex> ul(mtx_);
+    /**
+     * @brief Submit a task and get a Future that supports non-blocking continuations
+     * @tparam F Function type
+     * @tparam Args Argument types
+     * @param f Function to execute
+     * @param args Arguments to pass to the function
+     * @return Future whose then() continuations are scheduled onto this pool
+     * @throws std::runtime_error if pool is stopped, or queue is full under AdmissionPolicy::Reject
+     */
+    template<typename F, typename... Args>
+    auto async(F&& f, Args&&... args) -> Future<decltype(f(args...))> {
+        return async_with(TaskOptions(), std::forward<F>(f), std::forward<Args>(args)...);
+    }
 
-            if(stop_.load()) {
-                throw std::runtime_error("submit on stopped ThreadPool");
+    /**
+     * @brief async() with cancellation token and deadline
+     * @return Future that holds std::future_error (broken_promise) if the task was dropped
+     */
+    template<typename F, typename... Args>
+    auto async_with(const TaskOptions& options, F&& f, Args&&... args) -> Future<decltype(f(args...))> {
+        using return_type = decltype(f(args...));
+
+        auto promise = std::make_shared<Promise<return_type>>(this);
+        auto future = promise->get_future();
+        // Shared like submit_until's packaged_task, so move-only callables fit into std::function
+        auto bound = std::bind(std::forward<F>(f), std::forward<Args>(args)...);
+        auto shared = std::make_shared<decltype(bound)>(std::move(bound));
+        std::function<void()> task([promise, shared]() { detail::fulfil(*promise, *shared); });
+        throw_if_refused(admit(task, options, Clock::time_point::max()));
+        return future;
+    }
+
+    /**
+     * @brief Run fn(item) for every item of a range as separate tasks, queued under one lock
+     * @param range Items, copied into the batch
+     * @param fn Callable taking Item&, shared by all tasks
+     * @return One Future for the whole batch, rethrows the first exception once every task finished
+     * @throws std::runtime_error if pool is stopped (items already queued still run)
+     * @note Wakes at most one parked worker per queued task. A bounded queue is filled chunk by
+     *       chunk under AdmissionPolicy::Block; under other policies the overflow goes through the
+     *       policy one task at a time, and refused items fail the batch.
+     */
+    template<typename Range, typename F>
+    Future<void> submit_bulk(const Range& range, F&& fn) {
+        using Item = std::decay_t<decltype(*std::begin(range))>;
+        using State = detail::BulkState<Item, std::decay_t<F>>;
+
+        std::vector<Item> items(std::begin(range), std::end(range));
+        if(items.empty()) {
+            return make_ready_future(static_cast<Executor*>(this));
+        }
+        auto state = std::make_shared<State>(std::move(items), std::decay_t<F>(std::forward<F>(fn)), this);
+        auto future = state->promise.get_future();
+
+        std::vector<std::function<void()>> tasks;
+        tasks.reserve(state->items.size());
+        for(size_t i = 0; i < state->items.size(); ++i) {
+            tasks.emplace_back([state, i]() { state->run(i); });
+        }
+
+        SubmitStatus status = SubmitStatus::Ok;
+        size_t next = enqueue_bulk(tasks, status);
+        for(; next < tasks.size() && status == SubmitStatus::QueueFull; ++next) {
+            SubmitStatus item_status = admit(tasks[next], TaskOptions(), Clock::time_point::min());
+            if(item_status == SubmitStatus::Stopped) {
+                status = item_status;
+                break;
+            }
+            if(item_status != SubmitStatus::Ok) {
+                state->complete_one(std::make_exception_ptr(std::runtime_error("submit on full ThreadPool")));
             }
+        }
+        if(status == SubmitStatus::Stopped) {
+            throw_if_refused(status);
+        }
+        return future;
+    }
+
+    /**
+     * @brief Schedule a fire-and-forget task
+     * @param task Task to run
+     * @throws std::runtime_error if pool is stopped
+     * @note Never waits for queue space, so continuations posted from workers cannot deadlock a bounded pool
+     */
+    void post(std::function<void()> task) override {
+        post_with(TaskOptions(), std::move(task));
+    }
 
-            // Wait if queue is full (when max_queue_size_ > 0)
-            if (max_queue_size_ > 0) {
-                cv_producer_.wait(ul, [this]() {
-                    return stop_.load() || tasks_.size() < max_queue_size_;
-                });
+    /**
+     * @brief post() with cancellation token and deadline, a dropped task is destroyed without running
+     * @throws std::runtime_error if pool is stopped
+     */
+    void post_with(const TaskOptions& options, std::function<void()> task) {
+        if(enqueue(task, options, false, Clock::time_point::min()) == SubmitStatus::Stopped) {
+            throw std::runtime_error("submit on stopped ThreadPool");
+        }
+    }
 
-                if(stop_.load()) {
-                    throw std::runtime_error("submit on stopped ThreadPool");
+    /**
+     * @brief Only workers of this pool can help, other threads block on the future instead
+     */
+    bool can_help() const override {
+        return current_pool_ == this;
+    }
+
+    /**
+     * @brief Run one queued task on the calling worker, used by Future::wait/get and get()
+     * @return false if the queue is empty or the caller is not a worker of this pool
+     * @note The task may be anything queued, do not hold locks it could need
+     */
+    bool run_pending_task() override {
+        if(current_pool_ != this) {
+            return false;
+        }
+        std::unique_lock<std::mutex> ul(mtx_);
+        if(tasks_.empty()) {
+            return false;
+        }
+        Task task = pop_task();
+        queued_.store(tasks_.size(), std::memory_order_relaxed);
+        ul.unlock();
+        cv_producer_.notify_one();
+        run_task(task, Clock::now(), current_worker_->metrics, true);
+        return true;
+    }
+
+    /**
+     * @brief Wait for a std::future of this pool without losing the worker
+     * @param future Future returned by submit/submit_with/try_submit
+     * @return The future's value, rethrows its exception
+     * @note On a worker of this pool, queued tasks run while waiting, so divide-and-conquer code
+     *       that waits on its own subtasks cannot deadlock; elsewhere it is future.get()
+     */
+    template<typename R>
+    R get(std::future<R>& future) {
+        if(current_pool_ == this) {
+            while(future.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+                if(!run_pending_task()) {
+                    future.wait_for(std::chrono::microseconds(100));
                 }
             }
+        }
+        return future.get();
+    }
+
+    /**
+     * @brief Pool whose worker is running the calling thread
+     * @return nullptr outside pool workers
+     */
+    static ThreadPool* current() {
+        return current_pool_;
+    }
+
+    /**
+     * @brief Marks a blocking call inside a pool task, see ThreadPool::blocking()
+     */
+    class BlockingScope {
+    public:
+        BlockingScope(BlockingScope&& other) noexcept
+            : pool_(std::exchange(other.pool_, nullptr)), start_(other.start_) {}
+        BlockingScope(const BlockingScope&) = delete;
+        BlockingScope& operator=(const BlockingScope&) = delete;
+        BlockingScope& operator=(BlockingScope&&) = delete;
+
+        ~BlockingScope() {
+            if(pool_) {
+                pool_->end_blocking(start_);
+            }
+        }
+
+    private:
+        friend class ThreadPool;
+        BlockingScope(ThreadPool* pool, Clock::time_point start) : pool_(pool), start_(start) {}
+
+        ThreadPool* pool_;
+        Clock::time_point start_;
+    };
+
+    /**
+     * @brief Declare that the calling task is about to block (file I/O, IPC recv, sleeps)
+     * @return Scope that ends the blocking section when destroyed
+     * @note On a pool worker a compensating worker is spawned for the duration of the scope (up to
+     *       ThreadPoolOptions::max_blocking_compensation), so cpu-bound tasks keep their threads.
+     *       The time spent in scopes is counted per task in WorkerMetrics::blocking_time.
+     *       Nested scopes count once; outside pool workers this does nothing.
+     *
+     *   pool.submit([&]() {
+     *       auto scope = ThreadPool::blocking();
+     *       queue.recv(msg);
+     *   });
+     */
+    [[nodiscard]] static BlockingScope blocking() {
+        ThreadPool* pool = current_pool_;
+        if(!pool || blocking_depth_++ > 0) {
+            return BlockingScope(nullptr, Clock::time_point());
+        }
+        pool->begin_blocking();
+        return BlockingScope(pool, Clock::now());
+    }
 
-            tasks_.emplace([taskPtr]() { (*taskPtr)(); });
+    /**
+     * @brief Context of the calling worker: scratch arena reset after every task, and the
+     *        per-worker state created by ThreadPoolOptions::worker_init
+     * @return nullptr outside pool workers
+     */
+    static WorkerContext* worker_context() {
+        return current_context_;
+    }
+
+    /**
+     * @brief Awaitable that resumes the awaiting coroutine on a worker of this pool
+     * @note Usage: co_await pool.schedule(); see coroutine.hpp
+     */
+    struct ScheduleAwaiter {
+        ThreadPool* pool;
+
+        bool await_ready() const noexcept { return false; }
+
+        template<typename Handle>
+        void await_suspend(Handle handle) {
+            pool->post([handle]() mutable { handle.resume(); });
         }
-        cv_.notify_one();
-        return taskPtr->get_future();
+
+        void await_resume() const noexcept {}
+    };
+
+    ScheduleAwaiter schedule() {
+        return ScheduleAwaiter{this};
+    }
+
+    /**
+     * @brief Cancellation token of the task running on the calling worker
+     * @return Token to poll from long-running tasks, never cancelled outside pool tasks
+     */
+    static const CancellationToken& current_token() {
+        static const CancellationToken none;
+        return current_token_ ? *current_token_ : none;
     }
 
     /**
@@ -99,18 +544,600 @@ public:
      * @return Number of tasks in queue
      */
     size_t pending_tasks() const {
-        std::lock_guard<std::mutex> lock(mtx_);
-        return tasks_.size();
+        return queued_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Take a lock-free snapshot of the runtime metrics
+     * @return Per-worker and total task counts, queue wait/run time histograms,
+     *         busy/idle time and producer backpressure time
+     * @note Does not take the queue lock, cheap enough to call periodically in production
+     */
+    ThreadPoolMetrics metrics() const {
+        ThreadPoolMetrics result;
+        size_t slots = worker_slots_.load(std::memory_order_acquire);
+        result.workers.reserve(slots);
+        for(size_t i = 0; i < slots; ++i) {
+            const WorkerMetrics& m = workers_[i]->metrics;
+            WorkerMetricsSnapshot w;
+            w.tasks_executed = m.tasks_executed.load(std::memory_order_relaxed);
+            w.busy_ns = m.busy_ns.load(std::memory_order_relaxed);
+            w.idle_ns = m.idle_ns.load(std::memory_order_relaxed);
+            w.tasks_cancelled = m.tasks_cancelled.load(std::memory_order_relaxed);
+            w.tasks_expired = m.tasks_expired.load(std::memory_order_relaxed);
+            w.deadline_misses = m.deadline_misses.load(std::memory_order_relaxed);
+            w.tasks_helped = m.tasks_helped.load(std::memory_order_relaxed);
+            w.blocking_ns = m.blocking_ns.load(std::memory_order_relaxed);
+            w.blocking_time = m.blocking_time.snapshot();
+            w.queue_wait = m.queue_wait.snapshot();
+            w.run_time = m.run_time.snapshot();
+            result.total.tasks_executed += w.tasks_executed;
+            result.total.busy_ns += w.busy_ns;
+            result.total.idle_ns += w.idle_ns;
+            result.total.tasks_cancelled += w.tasks_cancelled;
+            result.total.tasks_expired += w.tasks_expired;
+            result.total.deadline_misses += w.deadline_misses;
+            result.total.tasks_helped += w.tasks_helped;
+            result.total.blocking_ns += w.blocking_ns;
+            result.total.blocking_time.merge(w.blocking_time);
+            result.total.queue_wait.merge(w.queue_wait);
+            result.total.run_time.merge(w.run_time);
+            result.workers.push_back(w);
+        }
+        result.thread_count = thread_count();
+        result.pending_tasks = pending_tasks();
+        result.producer_blocked_count = producer_blocked_count_.load(std::memory_order_relaxed);
+        result.producer_blocked_ns = producer_blocked_ns_.load(std::memory_order_relaxed);
+        result.tasks_rejected = tasks_rejected_.load(std::memory_order_relaxed);
+        result.tasks_evicted = tasks_evicted_.load(std::memory_order_relaxed);
+        result.tasks_caller_ran = tasks_caller_ran_.load(std::memory_order_relaxed);
+        result.blocking_compensations = blocking_compensations_.load(std::memory_order_relaxed);
+        return result;
+    }
+
+    /**
+     * @brief Get current number of live worker threads
+     * @note Fixed unless the pool is elastic (max_threads > min_threads)
+     */
+    size_t thread_count() const {
+        return live_workers_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Check if the pool grows and shrinks with load
+     */
+    bool is_elastic() const {
+        return max_threads_ > min_threads_;
+    }
+
+    /**
+     * @brief Get the options the pool was constructed with
+     */
+    const ThreadPoolOptions& options() const {
+        return options_;
     }
 
 private:
+    static ThreadPoolOptions make_options(size_t thread_num, size_t max_queue_size) {
+        ThreadPoolOptions options;
+        options.thread_num = thread_num;
+        options.max_queue_size = max_queue_size;
+        return options;
+    }
+
+    static void throw_if_refused(SubmitStatus status) {
+        if(status == SubmitStatus::Stopped) {
+            throw std::runtime_error("submit on stopped ThreadPool");
+        }
+        if(status != SubmitStatus::Ok) {
+            throw std::runtime_error("submit on full ThreadPool");
+        }
+    }
+
+    // Enqueue under the admission policy, runs the task inline for CallerRuns
+    SubmitStatus admit(std::function<void()>& task, const TaskOptions& options, Clock::time_point wait_deadline) {
+        SubmitStatus status = enqueue(task, options, true, wait_deadline);
+        if(status == SubmitStatus::QueueFull && options_.admission_policy == AdmissionPolicy::CallerRuns) {
+            tasks_caller_ran_.fetch_add(1, std::memory_order_relaxed);
+            task();
+            return SubmitStatus::Ok;
+        }
+        if(status == SubmitStatus::QueueFull || status == SubmitStatus::Timeout) {
+            tasks_rejected_.fetch_add(1, std::memory_order_relaxed);
+        }
+        return status;
+    }
+
+    // Called on a worker entering its outermost blocking scope
+    void begin_blocking() {
+        std::lock_guard<std::mutex> lock(mtx_);
+        ++blocked_workers_;
+        if(stop_.load() || compensating_ >= options_.max_blocking_compensation
+           || live_workers_.load(std::memory_order_relaxed) >= workers_.size()) {
+            return;
+        }
+        ++compensating_;
+        blocking_compensations_.fetch_add(1, std::memory_order_relaxed);
+        spawn_worker();
+    }
+
+    // Called on a worker leaving its outermost blocking scope: ask one surplus worker to retire
+    void end_blocking(Clock::time_point start) {
+        blocking_depth_ = 0;
+        uint64_t ns = elapsed_ns(start, Clock::now());
+        task_blocking_ns_ += ns;
+        detail::single_writer_add(current_worker_->metrics.blocking_ns, ns);
+        std::lock_guard<std::mutex> lock(mtx_);
+        --blocked_workers_;
+        if(compensating_ > blocked_workers_) {
+            --compensating_;
+            ++retire_requests_;
+            if(sleepers_ > 0) {
+                cv_.notify_one();
+            }
+        }
+    }
+
+    // Called without mtx_: queue tasks in order, one lock acquisition per chunk of free queue space.
+    // Returns the index of the first task not queued, status tells why (QueueFull only for non-Block policies).
+    size_t enqueue_bulk(std::vector<std::function<void()>>& tasks, SubmitStatus& status) {
+        size_t next = 0;
+        status = SubmitStatus::Ok;
+        std::unique_lock<std::mutex> ul(mtx_);
+        while(next < tasks.size()) {
+            if(stop_.load()) {
+                status = SubmitStatus::Stopped;
+                return next;
+            }
+            size_t count = tasks.size() - next;
+            if(max_queue_size_ > 0) {
+                if(tasks_.size() >= max_queue_size_) {
+                    if(options_.admission_policy != AdmissionPolicy::Block) {
+                        status = SubmitStatus::QueueFull;
+                        return next;
+                    }
+                    auto blocked_start = Clock::now();
+                    cv_producer_.wait(ul, [this]() { return stop_.load() || tasks_.size() < max_queue_size_; });
+                    producer_blocked_count_.fetch_add(1, std::memory_order_relaxed);
+                    producer_blocked_ns_.fetch_add(elapsed_ns(blocked_start, Clock::now()), std::memory_order_relaxed);
+                    continue;
+                }
+                count = std::min(count, max_queue_size_ - tasks_.size());
+            }
+            auto now = Clock::now();
+            for(size_t i = 0; i < count; ++i, ++next) {
+                push_task(Task{std::move(tasks[next]), now, CancellationToken(), Clock::time_point::max(), true,
+                               due_time(Clock::time_point::max(), now), next_seq_++, true});
+            }
+            queued_.store(tasks_.size(), std::memory_order_relaxed);
+            maybe_grow(now);
+            // Wake one parked worker per task at most, spinning workers pick the rest up by themselves
+            for(size_t i = 0; i < count && i < sleepers_; ++i) {
+                cv_.notify_one();
+            }
+        }
+        return next;
+    }
+
+    // Called without mtx_. task is moved from only when Ok is returned.
+    SubmitStatus enqueue(std::function<void()>& task, const TaskOptions& options,
+                         bool bounded, Clock::time_point wait_deadline) {
+        std::function<void()> evicted;  // Destroyed after the lock is released
+        std::unique_lock<std::mutex> ul(mtx_);
+        auto now = Clock::now();
+
+        if(stop_.load()) {
+            return SubmitStatus::Stopped;
+        }
+
+        if (bounded && max_queue_size_ > 0 && tasks_.size() >= max_queue_size_) {
+            switch(options_.admission_policy) {
+            case AdmissionPolicy::DropOldest: {
+                // post() work (strand drains, continuations, coroutine resumes) is exempt from the capacity
+                // and nothing would re-post it, so only tasks that went through a bounded submit may go
+                auto victim = tasks_.end();
+                if(options_.scheduling == SchedulingPolicy::EarliestDeadlineFirst) {
+                    // Evicting the heap top would drop the most urgent task: drop the least urgent one instead
+                    for(auto it = tasks_.begin(); it != tasks_.end(); ++it) {
+                        if(it->evictable && (victim == tasks_.end() || LaterDeadline()(*it, *victim))) {
+                            victim = it;
+                        }
+                    }
+                    if(victim != tasks_.end() && due_time(options.deadline, now) >= victim->due) {
+                        // The new task is the least urgent (ties go to the newest), refuse it
+                        return SubmitStatus::QueueFull;
+                    }
+                } else {
+                    victim = std::find_if(tasks_.begin(), tasks_.end(), [](const Task& t) { return t.evictable; });
+                }
+                if(victim == tasks_.end()) {
+                    return SubmitStatus::QueueFull;
+                }
+                evicted = std::move(victim->fn);
+                tasks_.erase(victim);
+                if(options_.scheduling == SchedulingPolicy::EarliestDeadlineFirst) {
+                    std::make_heap(tasks_.begin(), tasks_.end(), LaterDeadline());
+                }
+                tasks_evicted_.fetch_add(1, std::memory_order_relaxed);
+                break;
+            }
+            case AdmissionPolicy::Block: {
+                if(wait_deadline == Clock::time_point::min()) {
+                    return SubmitStatus::QueueFull;
+                }
+                auto has_space = [this]() { return stop_.load() || tasks_.size() < max_queue_size_; };
+                auto blocked_start = Clock::now();
+                bool ok = true;
+                if(wait_deadline == Clock::time_point::max()) {
+                    cv_producer_.wait(ul, has_space);
+                } else {
+                    ok = cv_producer_.wait_until(ul, wait_deadline, has_space);
+                }
+                producer_blocked_count_.fetch_add(1, std::memory_order_relaxed);
+                producer_blocked_ns_.fetch_add(elapsed_ns(blocked_start, Clock::now()), std::memory_order_relaxed);
+                if(stop_.load()) {
+                    return SubmitStatus::Stopped;
+                }
+                if(!ok) {
+                    return SubmitStatus::Timeout;
+                }
+                now = Clock::now();
+                break;
+            }
+            default:
+                return SubmitStatus::QueueFull;
+            }
+        }
+
+        push_task(Task{std::move(task), now, options.token, options.deadline, options.drop_if_late,
+                       due_time(options.deadline, now), next_seq_++, bounded});
+        queued_.store(tasks_.size(), std::memory_order_relaxed);
+        maybe_grow(now);
+        // Notify under the lock: tasks may be posted from other threads (timers, continuations),
+        // and the pool must not be destroyed between unlock and notify.
+        // Spinning workers see queued_ by themselves, only parked ones need the futex wake.
+        if(sleepers_ > 0) {
+            cv_.notify_one();
+        }
+        return SubmitStatus::Ok;
+    }
+
+    struct Task {
+        std::function<void()> fn;
+        Clock::time_point enqueue_time;
+        CancellationToken token;
+        Clock::time_point deadline;
+        bool drop_if_late;
+        Clock::time_point due;  // EDF order, see due_time()
+        uint64_t seq;  // Submission order, breaks deadline ties under EDF
+        bool evictable;  // Counted against max_queue_size, AdmissionPolicy::DropOldest may drop it
+    };
+
+    // Heap order for EDF: the top is the earliest due time, then the earliest submitted
+    struct LaterDeadline {
+        bool operator()(const Task& a, const Task& b) const {
+            return a.due != b.due ? a.due > b.due : a.seq > b.seq;
+        }
+    };
+
+    // EDF key: the deadline, or for a task without one its enqueue time plus no_deadline_slack, so
+    // internal work (strand drains, continuations, coroutine resumes) cannot starve behind deadlines
+    Clock::time_point due_time(Clock::time_point deadline, Clock::time_point now) const {
+        return deadline != Clock::time_point::max() ? deadline : now + options_.no_deadline_slack;
+    }
+
+    // Called with mtx_ held. FIFO is a plain deque, EDF keeps the same deque as a binary heap (O(log n)).
+    void push_task(Task&& task) {
+        tasks_.push_back(std::move(task));
+        if(options_.scheduling == SchedulingPolicy::EarliestDeadlineFirst) {
+            std::push_heap(tasks_.begin(), tasks_.end(), LaterDeadline());
+        }
+    }
+
+    // Called with mtx_ held, tasks_ must not be empty
+    Task pop_task() {
+        if(options_.scheduling == SchedulingPolicy::EarliestDeadlineFirst) {
+            std::pop_heap(tasks_.begin(), tasks_.end(), LaterDeadline());
+            Task task = std::move(tasks_.back());
+            tasks_.pop_back();
+            return task;
+        }
+        Task task = std::move(tasks_.front());
+        tasks_.pop_front();
+        return task;
+    }
+
+    struct Worker {
+        WorkerMetrics metrics;
+        std::thread thread;
+        bool exited = false;  // Retired by the elastic mode, slot can be reused
+    };
+
+    static uint64_t elapsed_ns(Clock::time_point from, Clock::time_point to) {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(to - from).count());
+    }
+
+    // Called with mtx_ held
+    void spawn_worker() {
+        size_t slots = worker_slots_.load(std::memory_order_relaxed);
+        size_t index = 0;
+        while(index < slots && !workers_[index]->exited) {
+            ++index;
+        }
+        if(index == slots) {
+            workers_[index] = std::make_unique<Worker>();
+            worker_slots_.store(slots + 1, std::memory_order_release);
+        } else if(workers_[index]->thread.joinable()) {
+            workers_[index]->thread.join();  // Retired thread has already released the lock for good
+        }
+        Worker* worker = workers_[index].get();
+        worker->exited = false;
+        live_workers_.fetch_add(1, std::memory_order_relaxed);
+        worker->thread = std::thread([this, worker, index]() { worker_loop(worker, index); });
+    }
+
+    // Called with mtx_ held: add a worker when the oldest task waited too long and nobody is idle
+    // (under EDF the head is the most urgent task rather than the oldest, close enough for growth)
+    void maybe_grow(Clock::time_point now) {
+        if(!is_elastic() || stop_.load() || tasks_.empty()
+           || live_workers_.load(std::memory_order_relaxed) >= max_threads_) {
+            return;
+        }
+        // A burst queued at once sees no further enqueue or dequeue, the supervisor re-checks it in time
+        wake_supervisor();
+        if(idle_workers_ > 0
+           || now - tasks_.front().enqueue_time < options_.spawn_wait_threshold
+           || now - last_resize_ < options_.resize_cooldown) {
+            return;
+        }
+        last_resize_ = now;
+        spawn_worker();
+    }
+
+    // Called with mtx_ held: some queued task has no idle worker to take it
+    void wake_supervisor() {
+        if(supervisor_parked_ && tasks_.size() > idle_workers_) {
+            supervisor_parked_ = false;
+            cv_supervisor_.notify_one();
+        }
+    }
+
+    // Elastic mode only: runs maybe_grow() when the queue head reaches spawn_wait_threshold,
+    // parks while the queue is empty or the pool is at max_threads
+    void supervise() {
+        if(!options_.name.empty()) {
+            set_current_thread_name(options_.name + "-grow");
+        }
+        std::unique_lock<std::mutex> ul(mtx_);
+        while(!stop_.load()) {
+            auto now = Clock::now();
+            maybe_grow(now);
+            if(tasks_.empty() || live_workers_.load(std::memory_order_relaxed) >= max_threads_) {
+                supervisor_parked_ = true;
+                cv_supervisor_.wait(ul, [this]() { return stop_.load() || !supervisor_parked_; });
+                continue;
+            }
+            auto wake = std::max(tasks_.front().enqueue_time + options_.spawn_wait_threshold,
+                                 last_resize_ + options_.resize_cooldown);
+            if(wake <= now) {
+                // Idle workers are about to take the queue, look again a threshold later
+                wake = now + std::max<Clock::duration>(options_.spawn_wait_threshold, std::chrono::microseconds(100));
+            }
+            cv_supervisor_.wait_until(ul, wake);
+        }
+    }
+
+    // Called with mtx_ held: retire after an idle timeout, never below min_threads
+    bool should_retire(Clock::time_point now) {
+        if(live_workers_.load(std::memory_order_relaxed) <= min_threads_
+           || now - last_resize_ < options_.resize_cooldown) {
+            return false;
+        }
+        last_resize_ = now;
+        return true;
+    }
+
+    void worker_loop(Worker* self, size_t index) {
+        setup_worker(index);
+        WorkerContext context(index, options_.scratch_arena_size);
+        current_pool_ = this;
+        current_worker_ = self;
+        current_context_ = &context;
+        if(options_.worker_init) {
+            try {
+                options_.worker_init(context);
+            } catch (const std::exception& e) {
+                std::cerr << "[THREAD] worker_init of worker " << index << " failed: " << e.what() << std::endl;
+            }
+        }
+        WorkerMetrics& metrics = self->metrics;
+        Clock::duration spin_budget = options_.max_spin;
+        std::unique_lock<std::mutex> ul(mtx_);
+        for(;;) {
+            // A blocked worker came back, the pool gives its compensating thread up
+            if(retire_requests_ > 0 && !stop_.load()) {
+                --retire_requests_;
+                if(live_workers_.load(std::memory_order_relaxed) > min_threads_) {
+                    live_workers_.fetch_sub(1, std::memory_order_relaxed);
+                    self->exited = true;
+                    return;
+                }
+            }
+            if(!stop_.load() && tasks_.empty()) {
+                ++idle_workers_;
+                bool retire = !wait_for_task(ul, metrics, spin_budget);
+                --idle_workers_;
+                if(retire) {
+                    live_workers_.fetch_sub(1, std::memory_order_relaxed);
+                    self->exited = true;
+                    return;
+                }
+            }
+            if(tasks_.empty()) {
+                if(stop_.load()) {
+                    return;
+                }
+                continue;
+            }
+            Task task = pop_task();
+            queued_.store(tasks_.size(), std::memory_order_relaxed);
+            auto start = Clock::now();
+            maybe_grow(start);
+            ul.unlock();
+            cv_producer_.notify_one();  // Notify if queue was full
+            run_task(task, start, metrics, false);
+            ul.lock();
+        }
+    }
+
+    // Called without mtx_. nested: run by a worker helping while it waits inside another task,
+    // whose busy time already covers this one.
+    void run_task(Task& task, Clock::time_point start, WorkerMetrics& metrics, bool nested) {
+        // Drop obsolete work before it costs any cpu, its future reports broken_promise
+        if(task.token.is_cancelled() || (task.drop_if_late && start > task.deadline)) {
+            detail::single_writer_add(task.token.is_cancelled() ? metrics.tasks_cancelled : metrics.tasks_expired, 1);
+            task.fn = nullptr;
+            return;
+        }
+        const CancellationToken* outer_token = current_token_;
+        ScratchArena& arena = current_context_->arena();
+        ScratchArena::Marker outer_scratch = arena.mark();  // A nested task must keep the outer task's scratch
+        uint64_t outer_blocking_ns = task_blocking_ns_;
+        task_blocking_ns_ = 0;
+        current_token_ = &task.token;
+        task.fn();
+        current_token_ = outer_token;
+        task.fn = nullptr;  // Release captures outside the lock
+        if(task_blocking_ns_ > 0) {
+            metrics.blocking_time.record(task_blocking_ns_);
+        }
+        task_blocking_ns_ = outer_blocking_ns;
+        if(nested) {
+            arena.rewind(outer_scratch);
+        } else {
+            arena.reset();
+        }
+        auto end = Clock::now();
+        if(end > task.deadline) {
+            detail::single_writer_add(metrics.deadline_misses, 1);
+        }
+        metrics.queue_wait.record(elapsed_ns(task.enqueue_time, start));
+        metrics.run_time.record(elapsed_ns(start, end));
+        if(nested) {
+            detail::single_writer_add(metrics.tasks_helped, 1);
+        } else {
+            detail::single_writer_add(metrics.busy_ns, elapsed_ns(start, end));
+        }
+        detail::single_writer_add(metrics.tasks_executed, 1);
+    }
+
+    // Called with mtx_ held; returns false if the worker should retire (elastic mode)
+    bool wait_for_task(std::unique_lock<std::mutex>& ul, WorkerMetrics& metrics, Clock::duration& spin_budget) {
+        auto ready = [this]() { return stop_.load() || !tasks_.empty() || retire_requests_ > 0; };
+        auto idle_start = Clock::now();
+        bool spin = options_.wait_strategy == WaitStrategy::SpinThenPark;
+        if(spin) {
+            ul.unlock();
+            spin_wait(spin_budget);
+            ul.lock();
+        }
+        bool woken = true;
+        if(!ready()) {
+            ++sleepers_;
+            if(is_elastic()) {
+                woken = cv_.wait_for(ul, options_.idle_timeout, ready);
+            } else {
+                cv_.wait(ul, ready);
+            }
+            --sleepers_;
+        }
+        auto idle_end = Clock::now();
+        detail::single_writer_add(metrics.idle_ns, elapsed_ns(idle_start, idle_end));
+        if(spin) {
+            // Grow the budget when work arrived shortly after giving up, shrink it when idle periods are long
+            Clock::duration max_spin = options_.max_spin;
+            Clock::duration idle = idle_end - idle_start;
+            if(idle <= 2 * max_spin) {
+                spin_budget = std::min(max_spin, 2 * spin_budget + std::chrono::microseconds(1));
+            } else {
+                spin_budget /= 2;
+            }
+        }
+        return woken || !should_retire(idle_end);
+    }
+
+    // Called without mtx_: poll the lock-free queue size, returns true if work (or stop) showed up
+    bool spin_wait(Clock::duration spin_budget) {
+        auto has_work = [this]() { return queued_.load(std::memory_order_relaxed) > 0 || stop_.load(std::memory_order_relaxed); };
+        auto spin_end = Clock::now() + spin_budget;
+        for(unsigned i = 1; ; ++i) {
+            if(has_work()) {
+                return true;
+            }
+            cpu_relax();
+            if((i & 63) == 0 && Clock::now() >= spin_end) {
+                break;
+            }
+        }
+        auto yield_end = Clock::now() + options_.yield_time;
+        while(Clock::now() < yield_end) {
+            if(has_work()) {
+                return true;
+            }
+            std::this_thread::yield();
+        }
+        return has_work();
+    }
+
+    // Runs on the worker thread before it starts taking tasks
+    void setup_worker(size_t index) {
+        if(!options_.name.empty()) {
+            set_current_thread_name(options_.name + "-" + std::to_string(index));
+        }
+        if(!options_.cpu_sets.empty()) {
+            set_current_thread_affinity(options_.cpu_sets[index % options_.cpu_sets.size()]);
+        }
+        if(options_.sched_policy != SCHED_OTHER || options_.sched_priority != 0) {
+            set_current_thread_scheduling(options_.sched_policy, options_.sched_priority);
+        }
+    }
+
+    static inline thread_local const CancellationToken* current_token_ = nullptr;
+    static inline thread_local ThreadPool* current_pool_ = nullptr;
+    static inline thread_local Worker* current_worker_ = nullptr;
+    static inline thread_local WorkerContext* current_context_ = nullptr;
+    static inline thread_local int blocking_depth_ = 0;
+    static inline thread_local uint64_t task_blocking_ns_ = 0;
+
     std::atomic<bool> stop_;
     size_t max_queue_size_;
-    std::vector<std::thread> workers_;
-    std::queue<std::function<void()>> tasks_;
+    ThreadPoolOptions options_;
+    size_t min_threads_;
+    size_t max_threads_;
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::atomic<size_t> worker_slots_{0};
+    std::atomic<size_t> live_workers_{0};
+    std::atomic<size_t> queued_{0};
+    std::atomic<uint64_t> producer_blocked_count_{0};
+    std::atomic<uint64_t> producer_blocked_ns_{0};
+    std::atomic<uint64_t> tasks_rejected_{0};
+    std::atomic<uint64_t> tasks_evicted_{0};
+    std::atomic<uint64_t> tasks_caller_ran_{0};
+    std::atomic<uint64_t> blocking_compensations_{0};
+    size_t idle_workers_ = 0;  // Spinning or parked
+    size_t sleepers_ = 0;      // Parked on cv_
+    size_t blocked_workers_ = 0;  // Inside ThreadPool::blocking() scopes
+    size_t compensating_ = 0;     // Workers spawned for blocked ones and not yet given back
+    size_t retire_requests_ = 0;  // Surplus workers that should exit at their next loop
+    Clock::time_point last_resize_{};
+    uint64_t next_seq_ = 0;
+    std::deque<Task> tasks_;
     mutable std::mutex mtx_;
     std::condition_variable cv_;
     std::condition_variable cv_producer_;  // For blocking when queue is full
+    std::condition_variable cv_supervisor_;
+    bool supervisor_parked_ = false;  // Supervisor waits for wake_supervisor() rather than a timeout
+    std::thread supervisor_;          // Elastic mode only
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,36 @@
+#ifndef __THREAD_POOL_CONFIG_H__
+#define __THREAD_POOL_CONFIG_H__
+
+#include "thread_pool.hpp"
+
+#include <string>
+
+/**
+ * @brief Read ThreadPool options from a section of the loaded parameter file
+ * @param section Top-level key in params.yaml, e.g. "control_pool"
+ * @return Options with missing keys left at their defaults (worker_init has to be set in code)
+ * @note Recognised keys:
+ *       thread_num: 2
+ *       max_queue_size: 0
+ *       admission_policy: "block" # block | reject | drop_oldest | caller_runs, when the queue is full
+ *       scheduling: "edf"        # fifo | edf (earliest TaskOptions::deadline first)
+ *       no_deadline_slack_ms: 100  # edf: tasks without a deadline are ordered as due this long after queueing
+ *       name: "ctrl"
+ *       cpus: ["2", "3"]         # cpu lists, worker i uses cpus[i % size]; one entry = shared set
+ *       numa_node: 0             # pin every worker to the cpus of this node when cpus is absent
+ *       sched_policy: "fifo"     # other | batch | idle | fifo | rr
+ *       sched_priority: 80
+ *       min_threads: 2           # elastic mode when max_threads > min_threads
+ *       max_threads: 8
+ *       spawn_wait_threshold_us: 1000
+ *       idle_timeout_ms: 10000
+ *       resize_cooldown_ms: 100
+ *       wait_strategy: "spin"    # block | spin (spin, then yield, then park)
+ *       max_spin_us: 50
+ *       yield_us: 20
+ *       scratch_arena_kb: 64      # first block of each worker's scratch arena
+ *       max_blocking_compensation: 4  # extra workers while tasks are in ThreadPool::blocking()
+ */
+ThreadPoolOptions LoadThreadPoolOptions(const std::string& section);
+
+#endif // __THREAD_POOL_CONFIG_H__
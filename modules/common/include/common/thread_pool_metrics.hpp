@@ -0,0 +1,159 @@
+#ifndef __THREAD_POOL_METRICS_H__
+#define __THREAD_POOL_METRICS_H__
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace detail {
+
+// Add to a counter that has a single writer thread: plain load/store, no locked instruction
+inline void single_writer_add(std::atomic<uint64_t>& counter, uint64_t value) {
+    counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+}  // namespace detail
+
+/**
+ * @brief Copy of a LatencyHistogram, bucket i counts samples in [2^(i-1), 2^i) ns
+ */
+struct HistogramSnapshot {
+    static constexpr size_t kBuckets = 40;  // Last bucket holds everything above ~4.6 min
+
+    std::array<uint64_t, kBuckets> buckets{};
+    uint64_t count = 0;
+    uint64_t sum_ns = 0;
+    uint64_t max_ns = 0;
+
+    double mean_us() const {
+        return count == 0 ? 0.0 : static_cast<double>(sum_ns) / count / 1000.0;
+    }
+
+    /**
+     * @brief Approximate percentile
+     * @param p Percentile in [0, 1]
+     * @return Upper bound of the bucket holding the percentile, in ns
+     */
+    uint64_t percentile_ns(double p) const {
+        if (count == 0) {
+            return 0;
+        }
+        uint64_t rank = static_cast<uint64_t>(p * static_cast<double>(count - 1)) + 1;
+        uint64_t seen = 0;
+        for (size_t i = 0; i < kBuckets; ++i) {
+            seen += buckets[i];
+            if (seen >= rank) {
+                return i + 1 == kBuckets ? max_ns : (uint64_t(1) << i);
+            }
+        }
+        return max_ns;
+    }
+
+    void merge(const HistogramSnapshot& other) {
+        for (size_t i = 0; i < kBuckets; ++i) {
+            buckets[i] += other.buckets[i];
+        }
+        count += other.count;
+        sum_ns += other.sum_ns;
+        max_ns = max_ns > other.max_ns ? max_ns : other.max_ns;
+    }
+};
+
+/**
+ * @brief Log2 latency histogram with one writer thread and lock-free readers
+ */
+class LatencyHistogram {
+public:
+    void record(uint64_t ns) {
+        size_t bucket = ns == 0 ? 0 : static_cast<size_t>(64 - __builtin_clzll(ns));
+        if (bucket >= HistogramSnapshot::kBuckets) {
+            bucket = HistogramSnapshot::kBuckets - 1;
+        }
+        detail::single_writer_add(buckets_[bucket], 1);
+        detail::single_writer_add(count_, 1);
+        detail::single_writer_add(sum_ns_, ns);
+        if (ns > max_ns_.load(std::memory_order_relaxed)) {
+            max_ns_.store(ns, std::memory_order_relaxed);
+        }
+    }
+
+    HistogramSnapshot snapshot() const {
+        HistogramSnapshot s;
+        for (size_t i = 0; i < HistogramSnapshot::kBuckets; ++i) {
+            s.buckets[i] = buckets_[i].load(std::memory_order_relaxed);
+        }
+        s.count = count_.load(std::memory_order_relaxed);
+        s.sum_ns = sum_ns_.load(std::memory_order_relaxed);
+        s.max_ns = max_ns_.load(std::memory_order_relaxed);
+        return s;
+    }
+
+private:
+    std::array<std::atomic<uint64_t>, HistogramSnapshot::kBuckets> buckets_{};
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> sum_ns_{0};
+    std::atomic<uint64_t> max_ns_{0};
+};
+
+/**
+ * @brief Counters owned and written by one worker thread
+ */
+struct alignas(64) WorkerMetrics {
+    std::atomic<uint64_t> tasks_executed{0};
+    std::atomic<uint64_t> busy_ns{0};          // Time spent running tasks
+    std::atomic<uint64_t> idle_ns{0};          // Time spent waiting for tasks
+    std::atomic<uint64_t> tasks_cancelled{0};  // Dropped before start, token cancelled
+    std::atomic<uint64_t> tasks_expired{0};    // Dropped before start, deadline passed
+    std::atomic<uint64_t> deadline_misses{0};  // Ran but finished after the deadline
+    std::atomic<uint64_t> tasks_helped{0};     // Run while waiting on a future inside another task
+    std::atomic<uint64_t> blocking_ns{0};      // Time spent in ThreadPool::blocking() scopes
+    LatencyHistogram queue_wait;               // Submit to start
+    LatencyHistogram run_time;                 // Start to finish
+    LatencyHistogram blocking_time;            // Per task time in blocking scopes, tasks that never blocked are not recorded
+};
+
+/**
+ * @brief Point-in-time copy of one worker's metrics
+ */
+struct WorkerMetricsSnapshot {
+    uint64_t tasks_executed = 0;
+    uint64_t busy_ns = 0;
+    uint64_t idle_ns = 0;
+    uint64_t tasks_cancelled = 0;
+    uint64_t tasks_expired = 0;
+    uint64_t deadline_misses = 0;
+    uint64_t tasks_helped = 0;
+    uint64_t blocking_ns = 0;
+    HistogramSnapshot queue_wait;
+    HistogramSnapshot run_time;
+    HistogramSnapshot blocking_time;
+
+    /**
+     * @brief Fraction of observed time spent running tasks, in [0, 1]
+     */
+    double utilization() const {
+        uint64_t total = busy_ns + idle_ns;
+        return total == 0 ? 0.0 : static_cast<double>(busy_ns) / total;
+    }
+};
+
+/**
+ * @brief Point-in-time copy of a ThreadPool's metrics, see ThreadPool::metrics()
+ * @note Counters are cumulative; diff two snapshots to get rates
+ */
+struct ThreadPoolMetrics {
+    std::vector<WorkerMetricsSnapshot> workers;  // One entry per worker slot, including retired ones
+    WorkerMetricsSnapshot total;                 // Sum over workers
+    size_t thread_count = 0;                     // Live workers
+    size_t pending_tasks = 0;                    // Queued, not started
+    uint64_t producer_blocked_count = 0;         // Submits that waited for queue space
+    uint64_t producer_blocked_ns = 0;            // Total time producers waited for queue space
+    uint64_t tasks_rejected = 0;                 // Refused: QueueFull/Timeout or AdmissionPolicy::Reject
+    uint64_t tasks_evicted = 0;                  // Dropped by AdmissionPolicy::DropOldest (the latest deadline under EDF)
+    uint64_t tasks_caller_ran = 0;               // Run on the submitting thread by AdmissionPolicy::CallerRuns
+    uint64_t blocking_compensations = 0;         // Workers spawned to replace workers in blocking scopes
+};
+
+#endif // __THREAD_POOL_METRICS_H__
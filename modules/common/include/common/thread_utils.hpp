@@ -0,0 +1,166 @@
+#ifndef __THREAD_UTILS_H__
+#define __THREAD_UTILS_H__
+
+#include <linux/futex.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <atomic>
+#include <cstdint>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <iostream>
+
+/**
+ * @brief Parse a Linux cpu list string such as "0-3,6,8-9"
+ * @param cpu_list Cpu list in sysfs/taskset format
+ * @return Sorted cpu ids, empty if the string is empty or malformed
+ */
+inline std::vector<int> parse_cpu_list(const std::string& cpu_list) {
+    std::vector<int> cpus;
+    std::stringstream ss(cpu_list);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        item.erase(0, item.find_first_not_of(" \t\n"));
+        item.erase(item.find_last_not_of(" \t\n") + 1);
+        if (item.empty()) {
+            continue;
+        }
+        try {
+            auto dash = item.find('-');
+            int first = std::stoi(item.substr(0, dash));
+            int last = dash == std::string::npos ? first : std::stoi(item.substr(dash + 1));
+            if (first < 0 || last < first) {
+                return {};
+            }
+            for (int cpu = first; cpu <= last; ++cpu) {
+                cpus.push_back(cpu);
+            }
+        } catch (const std::exception&) {
+            return {};
+        }
+    }
+    return cpus;
+}
+
+/**
+ * @brief Get the cpus that belong to a NUMA node
+ * @param node NUMA node index
+ * @return Cpu ids read from /sys/devices/system/node/node<N>/cpulist, empty if unavailable
+ */
+inline std::vector<int> numa_node_cpus(int node) {
+    std::ifstream file("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+    std::string cpu_list;
+    if (!file || !std::getline(file, cpu_list)) {
+        return {};
+    }
+    return parse_cpu_list(cpu_list);
+}
+
+/**
+ * @brief Set the name of the calling thread (truncated to 15 characters)
+ * @param name Thread name shown by top/htop/perf
+ * @return true on success
+ */
+inline bool set_current_thread_name(const std::string& name) {
+    return pthread_setname_np(pthread_self(), name.substr(0, 15).c_str()) == 0;
+}
+
+/**
+ * @brief Pin the calling thread to a set of cpus
+ * @param cpus Cpu ids, an empty set leaves the affinity unchanged
+ * @return true on success
+ */
+inline bool set_current_thread_affinity(const std::vector<int>& cpus) {
+    if (cpus.empty()) {
+        return true;
+    }
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    for (int cpu : cpus) {
+        if (cpu >= 0 && cpu < CPU_SETSIZE) {
+            CPU_SET(cpu, &cpu_set);
+        }
+    }
+    int ret = pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpu_set);
+    if (ret != 0) {
+        std::cerr << "[THREAD] Failed to set cpu affinity: " << strerror(ret) << std::endl;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Set scheduling policy and priority of the calling thread
+ * @param policy SCHED_OTHER, SCHED_BATCH, SCHED_IDLE, SCHED_FIFO or SCHED_RR
+ * @param priority Static priority, only meaningful for SCHED_FIFO/SCHED_RR
+ * @return true on success
+ * @note Real-time policies need CAP_SYS_NICE or a suitable RLIMIT_RTPRIO
+ */
+inline bool set_current_thread_scheduling(int policy, int priority) {
+    struct sched_param param;
+    memset(&param, 0, sizeof(param));
+    if (policy == SCHED_FIFO || policy == SCHED_RR) {
+        int min_priority = sched_get_priority_min(policy);
+        int max_priority = sched_get_priority_max(policy);
+        param.sched_priority = priority < min_priority ? min_priority
+                             : priority > max_priority ? max_priority : priority;
+    }
+    int ret = pthread_setschedparam(pthread_self(), policy, &param);
+    if (ret != 0) {
+        std::cerr << "[THREAD] Failed to set scheduling policy " << policy
+                  << " priority " << param.sched_priority << ": " << strerror(ret) << std::endl;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Hint the cpu that the caller is busy-waiting (pause/yield instruction)
+ */
+inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    asm volatile("yield" ::: "memory");
+#else
+    asm volatile("" ::: "memory");
+#endif
+}
+
+/**
+ * @brief Sleep while word == expected (FUTEX_WAIT), may return spuriously
+ * @param word Process-private 32-bit word
+ * @param expected Value observed before deciding to sleep, a concurrent change returns at once
+ */
+inline void futex_wait(std::atomic<uint32_t>& word, uint32_t expected) {
+    static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "futex needs a plain 32-bit word");
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT_PRIVATE, expected, nullptr, nullptr, 0);
+}
+
+/**
+ * @brief Wake up to count threads sleeping in futex_wait on word
+ */
+inline void futex_wake(std::atomic<uint32_t>& word, int count) {
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE_PRIVATE, count, nullptr, nullptr, 0);
+}
+
+/**
+ * @brief Convert a policy name ("other", "batch", "idle", "fifo", "rr") to its SCHED_* value
+ * @param name Policy name, case sensitive
+ * @return SCHED_* value, SCHED_OTHER for unknown names
+ */
+inline int sched_policy_from_string(const std::string& name) {
+    if (name == "fifo") return SCHED_FIFO;
+    if (name == "rr") return SCHED_RR;
+    if (name == "batch") return SCHED_BATCH;
+    if (name == "idle") return SCHED_IDLE;
+    return SCHED_OTHER;
+}
+
+#endif // __THREAD_UTILS_H__
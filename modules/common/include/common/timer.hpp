@@ -14,6 +14,10 @@
 #include <chrono>
 #include <cerrno>
 #include <iostream>
+#include <mutex>
+#include <condition_variable>
+#include <queue>
+#include <vector>
 
 /**
  * @brief RAII wrapper for file descriptors
@@ -204,6 +208,109 @@ private:
     TaskCallback callback_;
 };
 
+/**
+ * @brief One-shot timers for many waiters served by a single thread
+ * @note Callbacks run on the timer thread and should only hand work off (e.g. post to a ThreadPool)
+ */
+class TimerQueue {
+public:
+    using Clock = std::chrono::steady_clock;
+    using TaskCallback = std::function<void(void)>;
+
+    TimerQueue()
+        : stop_(false)
+        , sequence_(0) {
+        thread_ = std::thread([this]() { run(); });
+    }
+
+    ~TimerQueue() {
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            stop_ = true;
+        }
+        cv_.notify_all();
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+    }
+
+    TimerQueue(const TimerQueue&) = delete;
+    TimerQueue& operator=(const TimerQueue&) = delete;
+
+    /**
+     * @brief Run callback once at the given time
+     * @param when Expiry time on steady_clock
+     * @param callback Callback, dropped if the queue is destroyed first
+     */
+    void schedule_at(Clock::time_point when, TaskCallback callback) {
+        bool earliest;
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            earliest = entries_.empty() || when < entries_.top().when;
+            entries_.push(Entry{when, sequence_++, std::move(callback)});
+        }
+        if (earliest) {
+            cv_.notify_one();
+        }
+    }
+
+    /**
+     * @brief Run callback once after the given delay
+     */
+    template <typename Rep, typename Period>
+    void schedule_after(const std::chrono::duration<Rep, Period>& delay, TaskCallback callback) {
+        schedule_at(Clock::now() + std::chrono::duration_cast<Clock::duration>(delay), std::move(callback));
+    }
+
+    /**
+     * @brief Get number of timers that have not fired yet
+     */
+    size_t pending() const {
+        std::lock_guard<std::mutex> lock(mtx_);
+        return entries_.size();
+    }
+
+private:
+    struct Entry {
+        Clock::time_point when;
+        uint64_t sequence;  // FIFO order for equal expiry
+        TaskCallback callback;
+
+        bool operator>(const Entry& other) const {
+            return when != other.when ? when > other.when : sequence > other.sequence;
+        }
+    };
+
+    void run() {
+        std::unique_lock<std::mutex> lock(mtx_);
+        while (!stop_) {
+            if (entries_.empty()) {
+                cv_.wait(lock);
+                continue;
+            }
+            auto when = entries_.top().when;
+            if (Clock::now() < when) {
+                cv_.wait_until(lock, when);
+                continue;
+            }
+            auto callback = std::move(const_cast<Entry&>(entries_.top()).callback);
+            entries_.pop();
+            lock.unlock();
+            if (callback) {
+                callback();
+            }
+            lock.lock();
+        }
+    }
+
+    bool stop_;
+    uint64_t sequence_;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> entries_;
+    mutable std::mutex mtx_;
+    std::condition_variable cv_;
+    std::thread thread_;
+};
+
 #endif // __TIMER_H__
 
 // poll 实现
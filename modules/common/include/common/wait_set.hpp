@@ -0,0 +1,132 @@
+#ifndef __WAIT_SET_H__
+#define __WAIT_SET_H__
+
+#include <sys/epoll.h>
+#include <unistd.h>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <system_error>
+#include <vector>
+
+/**
+ * @brief Wait on several SafeQueues and file descriptors (timerfd, IPC, sockets) from one thread
+ *
+ * Each source gets an index in order of registration; wait_any() returns the indices that are ready.
+ * Sources are level-triggered, so a queue stays ready until it has been drained with try_pop().
+ *
+ *   WaitSet set;
+ *   size_t camera = set.add(camera_queue);
+ *   size_t imu = set.add(imu_queue);
+ *   size_t tick = set.add(timer_fd);
+ *   while (!camera_queue.stopped()) {
+ *       for (size_t ready : set.wait_any()) {
+ *           if (ready == camera) { while (camera_queue.try_pop(image)) { ... } }
+ *           else if (ready == tick) { read(timer_fd, &expirations, sizeof(expirations)); ... }
+ *       }
+ *   }
+ */
+class WaitSet {
+public:
+    WaitSet() : epoll_fd_(epoll_create1(EPOLL_CLOEXEC)) {
+        if (epoll_fd_ == -1) {
+            throw std::system_error(errno, std::generic_category(), "epoll_create1");
+        }
+    }
+
+    ~WaitSet() {
+        ::close(epoll_fd_);
+    }
+
+    WaitSet(const WaitSet&) = delete;
+    WaitSet& operator=(const WaitSet&) = delete;
+
+    /**
+     * @brief Watch a queue, ready while it holds elements or is stopped
+     * @param queue Any queue with ready_fd(), e.g. SafeQueue, must outlive the set or be removed first
+     * @return Index reported by wait_any()
+     */
+    template <typename Queue>
+    size_t add(Queue& queue) {
+        return add(queue.ready_fd());
+    }
+
+    /**
+     * @brief Watch a file descriptor, which stays owned by the caller
+     * @param fd File descriptor
+     * @param events epoll events to wait for
+     * @return Index reported by wait_any()
+     * @throws std::system_error if epoll_ctl fails
+     */
+    size_t add(int fd, uint32_t events = EPOLLIN) {
+        size_t index = fds_.size();
+        struct epoll_event ev;
+        ev.events = events;
+        ev.data.u64 = index;
+        if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev) == -1) {
+            throw std::system_error(errno, std::generic_category(), "epoll_ctl add");
+        }
+        fds_.push_back(fd);
+        events_.resize(fds_.size());
+        return index;
+    }
+
+    /**
+     * @brief Stop watching the source at index, the other indices stay valid
+     */
+    void remove(size_t index) {
+        if (index < fds_.size() && fds_[index] != -1) {
+            epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fds_[index], nullptr);
+            fds_[index] = -1;
+        }
+    }
+
+    /**
+     * @brief Block until at least one source is ready
+     * @return Indices of the ready sources, valid until the next wait
+     */
+    const std::vector<size_t>& wait_any() {
+        return wait(-1);
+    }
+
+    /**
+     * @brief Wait at most timeout for a source to become ready
+     * @return Indices of the ready sources, empty on timeout
+     */
+    template <typename Rep, typename Period>
+    const std::vector<size_t>& wait_any_for(const std::chrono::duration<Rep, Period>& timeout) {
+        auto ms = std::chrono::ceil<std::chrono::milliseconds>(timeout).count();
+        return wait(ms < 0 ? 0 : static_cast<int>(ms));
+    }
+
+private:
+    const std::vector<size_t>& wait(int timeout_ms) {
+        ready_.clear();
+        if (events_.empty()) {
+            return ready_;
+        }
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+        int nfds;
+        while ((nfds = epoll_wait(epoll_fd_, events_.data(), static_cast<int>(events_.size()), timeout_ms)) == -1) {
+            if (errno != EINTR) {
+                throw std::system_error(errno, std::generic_category(), "epoll_wait");
+            }
+            if (timeout_ms > 0) {
+                auto left = std::chrono::ceil<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+                timeout_ms = left.count() > 0 ? static_cast<int>(left.count()) : 0;
+            }
+        }
+        for (int i = 0; i < nfds; ++i) {
+            ready_.push_back(static_cast<size_t>(events_[i].data.u64));
+        }
+        return ready_;
+    }
+
+    int epoll_fd_;
+    std::vector<int> fds_;
+    std::vector<struct epoll_event> events_;
+    std::vector<size_t> ready_;
+};
+
+#endif // __WAIT_SET_H__
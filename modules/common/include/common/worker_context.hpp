@@ -0,0 +1,255 @@
+#ifndef __WORKER_CONTEXT_H__
+#define __WORKER_CONTEXT_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <typeindex>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Single-threaded bump allocator for scratch memory
+ * @note Memory is only reclaimed by rewind()/reset(), destructors of objects placed in it never run.
+ *       After a reset the blocks are merged, so a steady workload stops calling malloc.
+ */
+class ScratchArena {
+public:
+    struct Marker {
+        size_t block = 0;
+        size_t offset = 0;
+    };
+
+    /**
+     * @param block_size Size of the first block, allocated on first use
+     */
+    explicit ScratchArena(size_t block_size = 64 * 1024) : block_size_(block_size ? block_size : 1024) {}
+
+    ScratchArena(const ScratchArena&) = delete;
+    ScratchArena& operator=(const ScratchArena&) = delete;
+
+    /**
+     * @brief Allocate uninitialised memory
+     * @param bytes Size in bytes
+     * @param alignment Power of two alignment
+     * @return Pointer valid until the next rewind()/reset() past it
+     */
+    void* allocate(size_t bytes, size_t alignment = alignof(std::max_align_t)) {
+        while (current_ < blocks_.size()) {
+            void* p = bump(blocks_[current_], bytes, alignment);
+            if (p) {
+                return p;
+            }
+            ++current_;
+            if (current_ < blocks_.size()) {
+                blocks_[current_].used = 0;
+            }
+        }
+        size_t size = block_size_;
+        while (size < bytes + alignment) {
+            size *= 2;
+        }
+        blocks_.push_back(Block{std::unique_ptr<std::byte[]>(new std::byte[size]), size, 0});
+        current_ = blocks_.size() - 1;
+        return bump(blocks_[current_], bytes, alignment);
+    }
+
+    /**
+     * @brief Allocate an uninitialised array of T
+     */
+    template <typename T>
+    T* allocate(size_t count) {
+        return static_cast<T*>(allocate(count * sizeof(T), alignof(T)));
+    }
+
+    /**
+     * @brief Construct a T in the arena, its destructor will not run
+     */
+    template <typename T, typename... Args>
+    T* create(Args&&... args) {
+        static_assert(std::is_trivially_destructible<T>::value, "arena objects are never destroyed");
+        return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+
+    /**
+     * @brief Current position, see rewind()
+     */
+    Marker mark() const {
+        return Marker{current_, current_ < blocks_.size() ? blocks_[current_].used : 0};
+    }
+
+    /**
+     * @brief Release everything allocated after the marker
+     */
+    void rewind(const Marker& marker) {
+        current_ = marker.block;
+        if (current_ < blocks_.size()) {
+            blocks_[current_].used = marker.offset;
+        }
+    }
+
+    /**
+     * @brief Release everything, merging the blocks into one if the last cycle needed several
+     */
+    void reset() {
+        if (blocks_.size() > 1) {
+            size_t total = capacity();
+            blocks_.clear();
+            blocks_.push_back(Block{std::unique_ptr<std::byte[]>(new std::byte[total]), total, 0});
+        }
+        current_ = 0;
+        if (!blocks_.empty()) {
+            blocks_[0].used = 0;
+        }
+    }
+
+    /**
+     * @brief Bytes handed out since the last reset, including alignment padding
+     */
+    size_t used() const {
+        size_t total = 0;
+        for (size_t i = 0; i < blocks_.size() && i <= current_; ++i) {
+            total += i < current_ ? blocks_[i].size : blocks_[i].used;
+        }
+        return total;
+    }
+
+    size_t capacity() const {
+        size_t total = 0;
+        for (const auto& block : blocks_) {
+            total += block.size;
+        }
+        return total;
+    }
+
+private:
+    struct Block {
+        std::unique_ptr<std::byte[]> data;
+        size_t size;
+        size_t used;
+    };
+
+    static void* bump(Block& block, size_t bytes, size_t alignment) {
+        auto base = reinterpret_cast<uintptr_t>(block.data.get());
+        uintptr_t aligned = (base + block.used + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1);
+        if (aligned + bytes > base + block.size) {
+            return nullptr;
+        }
+        block.used = aligned + bytes - base;
+        return reinterpret_cast<void*>(aligned);
+    }
+
+    size_t block_size_;
+    std::vector<Block> blocks_;
+    size_t current_ = 0;
+};
+
+/**
+ * @brief Standard allocator on top of a ScratchArena, deallocate is a no-op
+ * @note std::vector<float, ArenaAllocator<float>> v{ArenaAllocator<float>(arena)};
+ */
+template <typename T>
+class ArenaAllocator {
+public:
+    using value_type = T;
+
+    explicit ArenaAllocator(ScratchArena& arena) noexcept : arena_(&arena) {}
+
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) noexcept : arena_(other.arena()) {}
+
+    T* allocate(size_t count) {
+        return arena_->allocate<T>(count);
+    }
+
+    void deallocate(T*, size_t) noexcept {}
+
+    ScratchArena* arena() const noexcept {
+        return arena_;
+    }
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U>& other) const noexcept {
+        return arena_ == other.arena();
+    }
+
+    template <typename U>
+    bool operator!=(const ArenaAllocator<U>& other) const noexcept {
+        return arena_ != other.arena();
+    }
+
+private:
+    ScratchArena* arena_;
+};
+
+/**
+ * @brief Per-worker context of a ThreadPool, see ThreadPool::worker_context()
+ *
+ *   options.worker_init = [](WorkerContext& ctx) { ctx.emplace<Solver>(ctx.index()); };
+ *   pool.submit([]() {
+ *       WorkerContext* ctx = ThreadPool::worker_context();
+ *       float* tmp = ctx->arena().allocate<float>(1024);  // freed when the task returns
+ *       ctx->get<Solver>()->run(tmp);
+ *   });
+ */
+class WorkerContext {
+public:
+    WorkerContext(size_t index, size_t arena_size) : index_(index), arena_(arena_size) {}
+
+    WorkerContext(const WorkerContext&) = delete;
+    WorkerContext& operator=(const WorkerContext&) = delete;
+
+    /**
+     * @brief Worker slot index, stable for the lifetime of the worker thread
+     */
+    size_t index() const {
+        return index_;
+    }
+
+    /**
+     * @brief Scratch memory of the running task, released when the task returns
+     */
+    ScratchArena& arena() {
+        return arena_;
+    }
+
+    /**
+     * @brief Create (or replace) the worker's state of type T, usually from ThreadPoolOptions::worker_init
+     */
+    template <typename T, typename... Args>
+    T& emplace(Args&&... args) {
+        auto value = std::make_shared<T>(std::forward<Args>(args)...);
+        T& ref = *value;
+        for (auto& entry : states_) {
+            if (entry.first == std::type_index(typeid(T))) {
+                entry.second = std::move(value);
+                return ref;
+            }
+        }
+        states_.emplace_back(std::type_index(typeid(T)), std::move(value));
+        return ref;
+    }
+
+    /**
+     * @brief Get the worker's state of type T
+     * @return nullptr if none was emplaced
+     */
+    template <typename T>
+    T* get() {
+        for (auto& entry : states_) {
+            if (entry.first == std::type_index(typeid(T))) {
+                return static_cast<T*>(entry.second.get());
+            }
+        }
+        return nullptr;
+    }
+
+private:
+    size_t index_;
+    ScratchArena arena_;
+    std::vector<std::pair<std::type_index, std::shared_ptr<void>>> states_;
+};
+
+#endif // __WORKER_CONTEXT_H__
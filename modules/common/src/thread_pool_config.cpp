@@ -0,0 +1,100 @@
+#include "common/thread_pool_config.hpp"
+#include "common/config.hpp"
+
+namespace {
+
+// Optional keys keep their default silently
+template <typename T>
+void ReadOptional(const std::string& section, const std::string& key, T& value) {
+    if (Config::HasParam(section, key)) {
+        value = Config::GetParam<T>(section, key, value);
+    }
+}
+
+template <typename Duration>
+void ReadDuration(const std::string& section, const std::string& key, Duration& value) {
+    auto count = static_cast<int64_t>(value.count());
+    ReadOptional(section, key, count);
+    value = Duration(count);
+}
+
+}  // namespace
+
+ThreadPoolOptions LoadThreadPoolOptions(const std::string& section) {
+    ThreadPoolOptions options;
+    options.thread_num = Config::GetParam<size_t>(section, "thread_num", options.thread_num);
+    ReadOptional(section, "max_queue_size", options.max_queue_size);
+    std::string admission_policy = "block";
+    ReadOptional(section, "admission_policy", admission_policy);
+    if (admission_policy == "reject") {
+        options.admission_policy = AdmissionPolicy::Reject;
+    } else if (admission_policy == "drop_oldest") {
+        options.admission_policy = AdmissionPolicy::DropOldest;
+    } else if (admission_policy == "caller_runs") {
+        options.admission_policy = AdmissionPolicy::CallerRuns;
+    } else if (admission_policy != "block") {
+        LOGE("[CONFIG] Unknown {}.admission_policy \"{}\", using block", section, admission_policy);
+    }
+    std::string scheduling = "fifo";
+    ReadOptional(section, "scheduling", scheduling);
+    if (scheduling == "edf") {
+        options.scheduling = SchedulingPolicy::EarliestDeadlineFirst;
+    } else if (scheduling != "fifo") {
+        LOGE("[CONFIG] Unknown {}.scheduling \"{}\", using fifo", section, scheduling);
+    }
+    ReadDuration(section, "no_deadline_slack_ms", options.no_deadline_slack);
+    options.name = section;
+    ReadOptional(section, "name", options.name);
+
+    auto cpus = Config::HasParam(section, "cpus")
+        ? Config::GetParam<std::vector<std::string>>(section, "cpus") : std::nullopt;
+    if (cpus.has_value()) {
+        for (const auto& cpu_list : cpus.value()) {
+            auto cpu_set = parse_cpu_list(cpu_list);
+            if (cpu_set.empty()) {
+                LOGE("[CONFIG] Invalid cpu list \"{}\" in {}.cpus, ignored", cpu_list, section);
+                continue;
+            }
+            options.cpu_sets.push_back(cpu_set);
+        }
+    } else if (Config::HasParam(section, "numa_node")) {
+        int numa_node = Config::GetParam<int>(section, "numa_node", 0);
+        auto cpu_set = numa_node_cpus(numa_node);
+        if (cpu_set.empty()) {
+            LOGE("[CONFIG] NUMA node {} in {}.numa_node is not available", numa_node, section);
+        } else {
+            options.cpu_sets.push_back(cpu_set);
+        }
+    }
+
+    std::string sched_policy = "other";
+    ReadOptional(section, "sched_policy", sched_policy);
+    options.sched_policy = sched_policy_from_string(sched_policy);
+    ReadOptional(section, "sched_priority", options.sched_priority);
+
+    ReadOptional(section, "min_threads", options.min_threads);
+    ReadOptional(section, "max_threads", options.max_threads);
+    ReadDuration(section, "spawn_wait_threshold_us", options.spawn_wait_threshold);
+    ReadDuration(section, "idle_timeout_ms", options.idle_timeout);
+    ReadDuration(section, "resize_cooldown_ms", options.resize_cooldown);
+
+    std::string wait_strategy = "block";
+    ReadOptional(section, "wait_strategy", wait_strategy);
+    if (wait_strategy == "spin") {
+        options.wait_strategy = WaitStrategy::SpinThenPark;
+    } else if (wait_strategy != "block") {
+        LOGE("[CONFIG] Unknown {}.wait_strategy \"{}\", using block", section, wait_strategy);
+    }
+    ReadDuration(section, "max_spin_us", options.max_spin);
+    ReadDuration(section, "yield_us", options.yield_time);
+
+    size_t scratch_arena_kb = options.scratch_arena_size / 1024;
+    ReadOptional(section, "scratch_arena_kb", scratch_arena_kb);
+    options.scratch_arena_size = scratch_arena_kb * 1024;
+    ReadOptional(section, "max_blocking_compensation", options.max_blocking_compensation);
+
+    LOGI("[CONFIG] Thread pool {}: {} threads [{}, {}], {} cpu sets, policy {}, priority {}",
+         section, options.thread_num, options.min_threads, options.max_threads,
+         options.cpu_sets.size(), options.sched_policy, options.sched_priority);
+    return options;
+}
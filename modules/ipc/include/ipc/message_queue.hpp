@@ -42,6 +42,13 @@ public:
      * @return {*}
      */
     bool recv(Message &msg);
+
+    /**
+     * @description: 非阻塞接收数据
+     * @param {Message} &msg
+     * @return {*} 队列为空时返回false且errno为ENOMSG
+     */
+    bool try_recv(Message &msg);
 };
 
 #endif // __MESSAGE_QUEUE_H__
@@ -47,4 +47,12 @@ bool MessageQueue::recv(MessageQueue::Message &msg) {
         return false;
     }
     return true;
-}
\ No newline at end of file
+}
+
+bool MessageQueue::try_recv(MessageQueue::Message &msg) {
+    // 接收队列中第一个消息，非阻塞
+    if (msgrcv(_msgid, &msg, sizeof(msg.text), 0, IPC_NOWAIT) == -1) {
+        return false;
+    }
+    return true;
+}